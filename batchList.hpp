@@ -0,0 +1,101 @@
+#ifndef BATCH_LIST_HPP
+#define BATCH_LIST_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+static bool isDirectory(const std::string& path)
+{
+	struct stat info;
+	return (stat(path.c_str(), &info) == 0) && ((info.st_mode & S_IFDIR) != 0);
+}
+
+//Fichiers d'un dossier (sans les sous dossiers ni les fichiers cachés), triés par nom
+static std::vector<std::string> listDirectory(const std::string& path)
+{
+	std::vector<std::string> names;
+
+#if defined(_MSC_VER)
+	WIN32_FIND_DATAA entry;
+	HANDLE find = FindFirstFileA((path + "\\*").c_str(), &entry);
+	if (find == INVALID_HANDLE_VALUE)
+		throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+	do
+	{
+		if ((entry.cFileName[0] != '.') && ((entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0))
+			names.emplace_back(entry.cFileName);
+	} while (FindNextFileA(find, &entry));
+
+	FindClose(find);
+#else
+	DIR* directory = opendir(path.c_str());
+	if (directory == nullptr)
+		throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+	while (const dirent* entry = readdir(directory))
+	{
+		if ((entry->d_name[0] != '.') && !isDirectory(path + "/" + entry->d_name))
+			names.emplace_back(entry->d_name);
+	}
+
+	closedir(directory);
+#endif
+
+	std::sort(names.begin(), names.end());
+
+	std::vector<std::string> ret;
+	for (const std::string& name: names)
+		ret.emplace_back(path + "/" + name);
+
+	return ret;
+}
+
+//Chemins d'un manifeste: un fichier par ligne, les lignes vides et celles qui commencent par # sont ignorées. Un chemin
+//relatif part du dossier du manifeste
+static std::vector<std::string> readManifest(const std::string& path)
+{
+	std::ifstream stream (path);
+	if (!stream.is_open())
+		throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+	const size_t slash = path.find_last_of("/\\");
+	const std::string directory = (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+
+	std::vector<std::string> ret;
+	std::string line;
+
+	while (std::getline(stream, line))
+	{
+		//Fin de ligne windows
+		if (!line.empty() && (line.back() == '\r'))
+			line.pop_back();
+
+		if (line.empty() || (line[0] == '#'))
+			continue;
+
+		const bool absolute = (line[0] == '/') || (line[0] == '\\') || ((line.size() > 1) && (line[1] == ':'));
+		ret.emplace_back(absolute ? line : directory + line);
+	}
+
+	return ret;
+}
+
+//Graphes d'un lot (wlmc --batch): les fichiers d'un dossier ou ceux d'un manifeste
+static std::vector<std::string> listBatchFiles(const std::string& path)
+{
+	return isDirectory(path) ? listDirectory(path) : readManifest(path);
+}
+
+#endif
@@ -0,0 +1,516 @@
+#include <map>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+//Banc d'essai de wlmc: génère avec ggen une grille fixe de graphes (même graine, donc mêmes graphes d'une fois sur
+//l'autre), lance wlmc plusieurs fois sur chacun et enregistre le temps total, le temps de lecture, le temps de
+//recherche (en millisecondes), la taille du front et la mémoire maximale de chaque lancement. Le mode --compare compare
+//deux enregistrements et signale les régressions, le mode --scaling mesure l'accélération de la recherche avec le
+//nombre de threads. Utilise fork/exec et wait4: Linux et Unix seulement
+
+//Un graphe de la grille
+struct Cell
+{
+	unsigned int vertices;
+	unsigned int edges;
+	unsigned int weights;
+};
+
+//La grille par défaut (make bench): de quelques millisecondes à une seconde environ par lancement
+static const std::vector<Cell> DEFAULT_CELLS = {
+	{ 500, 10000, 1 }, { 1000, 50000, 3 }, { 1000, 100000, 2 }, { 2000, 200000, 3 }, { 10000, 200000, 2 } };
+//Ajoutées par --large: plusieurs secondes par lancement, bien plus sur une machine lente
+static const std::vector<Cell> LARGE_CELLS = {
+	{ 10000, 1000000, 3 }, { 100000, 1000000, 3 }, { 100000, 2000000, 2 } };
+
+//Code de sortie de wlmc quand la recherche a été arrêtée par --time-limit (EXIT_INCOMPLETE dans wlmc.cpp)
+constexpr int WLMC_EXIT_INCOMPLETE = 2;
+
+//Une différence de moins de MIN_REGRESSION_MS millisecondes n'est jamais signalée: c'est du bruit
+constexpr double MIN_REGRESSION_MS = 5.0;
+
+struct Run
+{
+	Cell cell;
+	unsigned long long seed;
+	unsigned int run;
+	long long wallMs;
+	long long readMs;
+	long long solveMs;
+	long long frontSize;
+	long long peakRssKb;
+	int status;//Code de sortie de wlmc, -1 s'il a été tué
+};
+
+//Un lancement arrêté par la limite de temps n'a pas échoué, mais son temps et son front ne sont pas ceux d'une
+//recherche complète
+static const char* statusName(const int status)
+{
+	if (status == 0)
+		return "ok";
+	return (status == WLMC_EXIT_INCOMPLETE) ? "incomplete" : "failed";
+}
+
+//Le pire état des lancements d'une case
+static const char* worstStatus(const std::vector<Run>& runs)
+{
+	int ret = 0;
+
+	for (const Run& r: runs)
+	{
+		if ((r.status != 0) && (r.status != WLMC_EXIT_INCOMPLETE))
+			return statusName(r.status);
+		if (r.status == WLMC_EXIT_INCOMPLETE)
+			ret = WLMC_EXIT_INCOMPLETE;
+	}
+
+	return statusName(ret);
+}
+
+struct ProcessResult
+{
+	int status;
+	std::string output;
+	long long wallMs;
+	long long peakRssKb;
+};
+
+//Lance args[0] avec ses arguments et attend sa fin. La sortie standard est récupérée, la sortie d'erreur est gardée
+static ProcessResult runProcess(const std::vector<std::string>& args)
+{
+	ProcessResult ret = { -1, "", 0, 0 };
+	int fds[2];
+
+	if (pipe(fds) != 0)
+		return ret;
+
+	const auto start = std::chrono::steady_clock::now();
+	const pid_t pid = fork();
+
+	if (pid == 0)
+	{
+		std::vector<char*> argv;
+		for (const std::string& a: args)
+			argv.emplace_back(const_cast<char*>(a.c_str()));
+		argv.emplace_back(nullptr);
+
+		dup2(fds[1], STDOUT_FILENO);
+		close(fds[0]);
+		close(fds[1]);
+		execv(argv[0], argv.data());
+		_exit(127);
+	}
+
+	close(fds[1]);
+
+	char buffer[4096];
+	ssize_t size;
+	while ((size = read(fds[0], buffer, sizeof(buffer))) > 0)
+		ret.output.append(buffer, (size_t)size);
+	close(fds[0]);
+
+	int status = 0;
+	struct rusage usage;
+	std::memset(&usage, 0, sizeof(usage));
+	if ((pid > 0) && (wait4(pid, &status, 0, &usage) == pid))
+	{
+		ret.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+		//ru_maxrss est en kilo-octets sous Linux
+		ret.peakRssKb = usage.ru_maxrss;
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+	ret.wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+	return ret;
+}
+
+//Nombre qui suit la première occurrence de key dans text, -1 s'il n'y en a pas
+static long long numberAfter(const std::string& text, const std::string& key)
+{
+	const size_t pos = text.find(key);
+	return (pos == std::string::npos) ? -1 : std::strtoll(text.c_str() + pos + key.size(), nullptr, 10);
+}
+
+static std::string cellName(const Cell& c)
+{
+	return std::to_string(c.vertices) + "_" + std::to_string(c.edges) + "_" + std::to_string(c.weights);
+}
+
+static bool fileExists(const std::string& path)
+{
+	struct stat info;
+	return stat(path.c_str(), &info) == 0;
+}
+
+static const char* CSV_HEADER = "vertices,edges,weights,seed,run,wall_ms,read_ms,solve_ms,front_size,peak_rss_kb,status";
+
+static void writeCsv(std::ostream& stream, const std::vector<Run>& runs)
+{
+	stream << CSV_HEADER << "\n";
+
+	for (const Run& r: runs)
+	{
+		stream << r.cell.vertices << "," << r.cell.edges << "," << r.cell.weights << "," << r.seed << "," << r.run << ","
+			<< r.wallMs << "," << r.readMs << "," << r.solveMs << "," << r.frontSize << "," << r.peakRssKb << "," << r.status << "\n";
+	}
+}
+
+static void writeJson(std::ostream& stream, const std::vector<Run>& runs)
+{
+	stream << "[\n";
+
+	for (size_t i = 0; i < runs.size(); ++i)
+	{
+		const Run& r = runs[i];
+		stream << "  { \"vertices\": " << r.cell.vertices << ", \"edges\": " << r.cell.edges << ", \"weights\": " << r.cell.weights
+			<< ", \"seed\": " << r.seed << ", \"run\": " << r.run << ", \"wall_ms\": " << r.wallMs << ", \"read_ms\": " << r.readMs
+			<< ", \"solve_ms\": " << r.solveMs << ", \"front_size\": " << r.frontSize << ", \"peak_rss_kb\": " << r.peakRssKb
+			<< ", \"status\": " << r.status << " }" << ((i + 1 < runs.size()) ? "," : "") << "\n";
+	}
+
+	stream << "]\n";
+}
+
+static std::vector<Run> readCsv(const std::string& path)
+{
+	std::ifstream stream (path);
+	if (!stream.is_open())
+		throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+	std::vector<Run> ret;
+	std::string line;
+	std::getline(stream, line);
+
+	if (line != CSV_HEADER)
+		throw std::logic_error("ERROR: '" + path + "' is not a wlmcbench CSV file");
+
+	while (std::getline(stream, line))
+	{
+		if (line.empty())
+			continue;
+
+		Run r;
+		char comma;
+		std::istringstream fields (line);
+		fields >> r.cell.vertices >> comma >> r.cell.edges >> comma >> r.cell.weights >> comma >> r.seed >> comma >> r.run >> comma
+			>> r.wallMs >> comma >> r.readMs >> comma >> r.solveMs >> comma >> r.frontSize >> comma >> r.peakRssKb >> comma >> r.status;
+
+		if (fields.fail())
+			throw std::logic_error("ERROR: '" + path + "' contains an invalid line: '" + line + "'");
+
+		ret.emplace_back(r);
+	}
+
+	return ret;
+}
+
+static double median(std::vector<long long> values)
+{
+	if (values.empty())
+		return 0.0;
+
+	std::sort(values.begin(), values.end());
+	const size_t middle = values.size() / 2;
+	return (values.size() % 2 == 1) ? (double)values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+//Les lancements d'une même case (mêmes graphe et graine), dans l'ordre de la grille
+static std::vector<std::pair<std::string, std::vector<Run>>> groupByCell(const std::vector<Run>& runs)
+{
+	std::vector<std::pair<std::string, std::vector<Run>>> ret;
+
+	for (const Run& r: runs)
+	{
+		const std::string key = cellName(r.cell) + "_s" + std::to_string(r.seed);
+		auto found = std::find_if(ret.begin(), ret.end(), [&key](const std::pair<std::string, std::vector<Run>>& g) { return g.first == key; });
+
+		if (found == ret.end())
+			ret.emplace_back(key, std::vector<Run>{ r });
+		else
+			found->second.emplace_back(r);
+	}
+
+	return ret;
+}
+
+template <class F>
+static double medianOf(const std::vector<Run>& runs, F field)
+{
+	std::vector<long long> values;
+	for (const Run& r: runs)
+		values.emplace_back(field(r));
+	return median(values);
+}
+
+static void printSummary(const std::vector<Run>& runs)
+{
+	std::printf("%-28s %5s %10s %10s %10s %8s %10s  %s\n", "cell", "runs", "wall ms", "read ms", "solve ms", "front", "rss KB", "status");
+
+	for (const auto& group: groupByCell(runs))
+	{
+		long long rss = 0;
+		for (const Run& r: group.second)
+			rss = std::max(rss, r.peakRssKb);
+
+		std::printf("%-28s %5zu %10.1f %10.1f %10.1f %8.0f %10lld  %s\n", group.first.c_str(), group.second.size(),
+			medianOf(group.second, [](const Run& r) { return r.wallMs; }), medianOf(group.second, [](const Run& r) { return r.readMs; }),
+			medianOf(group.second, [](const Run& r) { return r.solveMs; }), medianOf(group.second, [](const Run& r) { return r.frontSize; }), rss,
+			worstStatus(group.second));
+	}
+}
+
+//Compare les temps médians de chaque case: une case est une régression si son temps dépasse celui de base de plus de
+//tolerance pourcents (et d'au moins MIN_REGRESSION_MS). Un front de taille différente est toujours signalé, sauf si
+//une des deux cases a été arrêtée par la limite de temps: elle est alors marquée incomplete et son temps n'est pas
+//comparé. Un lancement qui a échoué est un problème. Renvoie le nombre de problèmes trouvés
+static int compare(const std::string& basePath, const std::string& newPath, const double tolerance)
+{
+	const auto baseGroups = groupByCell(readCsv(basePath));
+	const auto newGroups = groupByCell(readCsv(newPath));
+	int problems = 0;
+
+	std::printf("%-28s %12s %12s %8s  %s\n", "cell", "base ms", "new ms", "change", "");
+
+	for (const auto& n: newGroups)
+	{
+		auto b = std::find_if(baseGroups.begin(), baseGroups.end(), [&n](const std::pair<std::string, std::vector<Run>>& g) { return g.first == n.first; });
+
+		if (b == baseGroups.end())
+		{
+			std::printf("%-28s %12s %12s %8s  only in '%s'\n", n.first.c_str(), "-", "-", "-", newPath.c_str());
+			continue;
+		}
+
+		const double baseMs = medianOf(b->second, [](const Run& r) { return r.wallMs; });
+		const double newMs = medianOf(n.second, [](const Run& r) { return r.wallMs; });
+		const double change = (baseMs > 0.0) ? 100.0 * (newMs - baseMs) / baseMs : 0.0;
+		const std::string baseStatus = worstStatus(b->second);
+		const std::string newStatus = worstStatus(n.second);
+		std::string verdict;
+
+		if ((baseStatus == "failed") || (newStatus == "failed"))
+		{
+			verdict = "FAILED";
+			++problems;
+		}
+		else if ((baseStatus == "incomplete") || (newStatus == "incomplete"))
+			verdict = "incomplete";
+		else if (medianOf(b->second, [](const Run& r) { return r.frontSize; }) != medianOf(n.second, [](const Run& r) { return r.frontSize; }))
+		{
+			verdict = "FRONT SIZE MISMATCH";
+			++problems;
+		}
+		else if ((change > tolerance) && (newMs - baseMs >= MIN_REGRESSION_MS))
+		{
+			verdict = "REGRESSION";
+			++problems;
+		}
+		else if ((change < -tolerance) && (baseMs - newMs >= MIN_REGRESSION_MS))
+			verdict = "improvement";
+
+		std::printf("%-28s %12.1f %12.1f %+7.1f%%  %s\n", n.first.c_str(), baseMs, newMs, change, verdict.c_str());
+	}
+
+	return problems;
+}
+
+static Cell parseCell(const std::string& text)
+{
+	Cell ret;
+	if (std::sscanf(text.c_str(), "%u,%u,%u", &ret.vertices, &ret.edges, &ret.weights) != 3)
+		throw std::logic_error("ERROR: a cell is '<vertices>,<edges>,<weights>', not '" + text + "'");
+	return ret;
+}
+
+//Accélération de la recherche de chaque case: temps de recherche médian pour chaque nombre de threads, rapporté à
+//celui du premier nombre. Au delà du nombre de coeurs de la machine, les threads se partagent les coeurs et
+//l'accélération ne mesure plus que le coût du parallélisme
+static void printScaling(const std::vector<Run>& runs, const std::vector<unsigned int>& threads)
+{
+	const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if ((cores > 0) && (*std::max_element(threads.begin(), threads.end()) > (unsigned long)cores))
+		std::printf("warning: this machine has %ld core(s), the speedup beyond %ld threads is not meaningful\n", cores, cores);
+
+	std::printf("%-28s %8s %10s %8s %10s  %s\n", "cell", "threads", "solve ms", "speedup", "efficiency", "status");
+
+	//Les lancements d'une case sont rangés par nombre de threads, threads.size() groupes de même taille
+	for (const auto& group: groupByCell(runs))
+	{
+		const size_t perThreads = group.second.size() / threads.size();
+		double baseMs = 0.0;
+
+		for (size_t t = 0; t < threads.size(); ++t)
+		{
+			const std::vector<Run> same (group.second.begin() + t * perThreads, group.second.begin() + (t + 1) * perThreads);
+			const double solveMs = medianOf(same, [](const Run& r) { return r.solveMs; });
+			const double speedup = (solveMs > 0.0) ? ((t == 0) ? 1.0 : baseMs / solveMs) : 0.0;
+
+			if (t == 0)
+				baseMs = solveMs;
+
+			std::printf("%-28s %8u %10.1f %8.2f %9.0f%%  %s\n", group.first.c_str(), threads[t], solveMs, speedup,
+				100.0 * speedup * threads[0] / threads[t], worstStatus(same));
+		}
+	}
+}
+
+static std::vector<unsigned int> parseThreads(const std::string& text)
+{
+	std::vector<unsigned int> ret;
+	std::istringstream fields (text);
+	std::string field;
+
+	while (std::getline(fields, field, ','))
+	{
+		char* end = nullptr;
+		const unsigned long threads = std::strtoul(field.c_str(), &end, 10);
+		if (field.empty() || (*end != '\0') || (threads == 0))
+			throw std::logic_error("ERROR: --scaling takes thread counts separated by commas, not '" + text + "'");
+		ret.emplace_back((unsigned int)threads);
+	}
+
+	return ret;
+}
+
+static const char* USAGE =
+	"arguments are [--wlmc <path>] [--ggen <path>] [--dir <graph directory>] [--runs <n>] [--seed <seed>] [--threads <n>]\n"
+	"              [--time-limit <seconds>] [--large] [--cell <vertices>,<edges>,<weights>]... [--csv <path>] [--json <path>]\n"
+	"              [--scaling <threads>,<threads>...]\n"
+	"           or --compare <base csv> <new csv> [--tolerance <percent>]\n";
+
+//Format: voir USAGE. Sans --cell, la grille par défaut est utilisée, --large y ajoute les grandes cases. Chaque
+//lancement de wlmc est limité à --time-limit secondes (60 par défaut, 0 pour aucune limite). Les graphes générés sont
+//gardés dans --dir et réutilisés tant que la graine ne change pas. Avec --scaling, chaque case est lancée avec
+//chacun des nombres de threads donnés (à la place de --threads) et l'accélération est affichée après le résumé
+int main(int argc, const char** argv)
+{
+	std::map<std::string, std::string> options = { { "--wlmc", "./wlmc" }, { "--ggen", "./ggen" }, { "--dir", "bench_graphs" },
+		{ "--runs", "3" }, { "--seed", "1" }, { "--threads", "1" }, { "--time-limit", "60" }, { "--csv", "" }, { "--json", "" },
+		{ "--tolerance", "10" }, { "--scaling", "" } };
+	std::vector<Cell> cells;
+	bool large = false;
+	std::vector<std::string> compared;
+
+	try
+	{
+		for (int a = 1; a < argc; ++a)
+		{
+			const std::string arg (argv[a]);
+
+			if ((arg == "--cell") && (a + 1 < argc))
+				cells.emplace_back(parseCell(argv[++a]));
+			else if (arg == "--large")
+				large = true;
+			else if ((arg == "--compare") && (a + 2 < argc))
+			{
+				compared.emplace_back(argv[++a]);
+				compared.emplace_back(argv[++a]);
+			}
+			else if ((options.count(arg) != 0) && (a + 1 < argc))
+				options[arg] = argv[++a];
+			else
+			{
+				std::cerr << "ERROR: " << USAGE;
+				return EXIT_FAILURE;
+			}
+		}
+
+		if (!compared.empty())
+			return (compare(compared[0], compared[1], std::stod(options["--tolerance"])) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+		if (cells.empty())
+		{
+			cells = DEFAULT_CELLS;
+			if (large)
+				cells.insert(cells.end(), LARGE_CELLS.begin(), LARGE_CELLS.end());
+		}
+
+		const std::string seed = options["--seed"];
+		const unsigned int runCount = (unsigned int)std::stoul(options["--runs"]);
+		if (!options["--scaling"].empty() && (!options["--csv"].empty() || !options["--json"].empty()))
+			throw std::logic_error("ERROR: --scaling cannot be combined with --csv or --json");
+
+		const std::vector<unsigned int> threads = options["--scaling"].empty()
+			? std::vector<unsigned int>{ (unsigned int)std::stoul(options["--threads"]) } : parseThreads(options["--scaling"]);
+		mkdir(options["--dir"].c_str(), 0755);
+
+		std::vector<Run> runs;
+
+		for (const Cell& cell: cells)
+		{
+			const std::string path = options["--dir"] + "/g_" + cellName(cell) + "_s" + seed + ".txt";
+
+			if (!fileExists(path))
+			{
+				const ProcessResult generated = runProcess({ options["--ggen"], "--seed", seed, path, std::to_string(cell.weights),
+					std::to_string(cell.vertices), std::to_string(cell.edges) });
+
+				if (generated.status != 0)
+					throw std::logic_error("ERROR: '" + options["--ggen"] + "' could not generate '" + path + "'");
+			}
+
+			for (unsigned int t: threads)
+			{
+				for (unsigned int r = 0; r < runCount; ++r)
+				{
+					const ProcessResult result = runProcess({ options["--wlmc"], "--threads", std::to_string(t), "--time-limit", options["--time-limit"], path });
+
+					Run run;
+					run.cell = cell;
+					run.seed = std::stoull(seed);
+					run.run = r;
+					run.wallMs = result.wallMs;
+					run.readMs = numberAfter(result.output, "Begin reading... took: ");
+					run.solveMs = numberAfter(result.output, " cliques   took: ");
+					run.frontSize = numberAfter(result.output, "found: ");
+					run.peakRssKb = result.peakRssKb;
+					run.status = result.status;
+					runs.emplace_back(run);
+
+					std::cerr << cellName(cell) << ((threads.size() > 1) ? " threads " + std::to_string(t) : "") << " run " << r << ": "
+						<< run.wallMs << "ms" << ((run.status != 0) ? "   " : "") << ((run.status != 0) ? statusName(run.status) : "") << std::endl;
+				}
+			}
+		}
+
+		//Le CSV et le résumé n'ont pas de colonne pour le nombre de threads
+		if (options["--scaling"].empty())
+			printSummary(runs);
+		else
+			printScaling(runs, threads);
+
+		if (!options["--csv"].empty())
+		{
+			std::ofstream csv (options["--csv"]);
+			writeCsv(csv, runs);
+		}
+
+		if (!options["--json"].empty())
+		{
+			std::ofstream json (options["--json"]);
+			writeJson(json, runs);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
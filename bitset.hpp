@@ -0,0 +1,100 @@
+#ifndef BITSET_HPP
+#define BITSET_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using BitsetWord = uint64_t;
+constexpr size_t BITSET_WORD_BITS = 64;
+
+static inline size_t wordCountFor(const size_t bitCount) { return (bitCount + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS; }
+
+static inline unsigned int popcount(const BitsetWord w)
+{
+#if defined(_MSC_VER)
+	return (unsigned int)__popcnt64(w);
+#else
+	return (unsigned int)__builtin_popcountll(w);
+#endif
+}
+
+static inline unsigned int lowestBit(const BitsetWord w)
+{
+#if defined(_MSC_VER)
+	unsigned long pos;
+	_BitScanForward64(&pos, w);
+	return (unsigned int)pos;
+#else
+	return (unsigned int)__builtin_ctzll(w);
+#endif
+}
+
+//Ensemble de bits de taille fixe. Les opérations se font mot par mot (64 bits à la fois), les boucles
+//sont assez simples pour que le compilateur les vectorise (SSE/AVX2) quand il en a le droit
+class Bitset
+{
+public:
+	Bitset(const size_t bitCount = 0): m_words(wordCountFor(bitCount), 0), m_bitCount(bitCount) {}
+
+public:
+	void set(const size_t pos) { m_words[pos / BITSET_WORD_BITS] |= BitsetWord(1) << (pos % BITSET_WORD_BITS); }
+	void reset(const size_t pos) { m_words[pos / BITSET_WORD_BITS] &= ~(BitsetWord(1) << (pos % BITSET_WORD_BITS)); }
+	bool test(const size_t pos) const { return (m_words[pos / BITSET_WORD_BITS] >> (pos % BITSET_WORD_BITS)) & 1; }
+
+	size_t size(void) const { return m_bitCount; }
+	size_t wordCount(void) const { return m_words.size(); }
+
+	BitsetWord* data(void) { return m_words.data(); }
+	const BitsetWord* data(void) const { return m_words.data(); }
+
+private:
+	std::vector<BitsetWord> m_words;
+	size_t m_bitCount;
+};
+
+//Matrice d'adjacence dense: une ligne de bits par sommet, toutes les lignes sont contigues en mémoire
+class BitMatrix
+{
+public:
+	BitMatrix(const size_t n = 0): m_n(n), m_wordsPerRow(wordCountFor(n)), m_words(m_n * m_wordsPerRow, 0) {}
+
+public:
+	void set(const size_t row, const size_t col)
+	{
+		m_words[row * m_wordsPerRow + col / BITSET_WORD_BITS] |= BitsetWord(1) << (col % BITSET_WORD_BITS);
+	}
+
+	bool test(const size_t row, const size_t col) const
+	{
+		return (m_words[row * m_wordsPerRow + col / BITSET_WORD_BITS] >> (col % BITSET_WORD_BITS)) & 1;
+	}
+
+	const BitsetWord* row(const size_t r) const { return m_words.data() + r * m_wordsPerRow; }
+
+	size_t size(void) const { return m_n; }
+
+	//|row(r) & mask| sans construire l'intersection
+	size_t rowIntersectionCount(const size_t r, const Bitset& mask) const
+	{
+		const BitsetWord* rowWords = row(r);
+		const BitsetWord* maskWords = mask.data();
+		size_t ret = 0;
+
+		for (size_t i = 0; i < m_wordsPerRow; ++i)
+			ret += popcount(rowWords[i] & maskWords[i]);
+
+		return ret;
+	}
+
+private:
+	size_t m_n;
+	size_t m_wordsPerRow;
+	std::vector<BitsetWord> m_words;
+};
+
+#endif
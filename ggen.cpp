@@ -1,61 +1,442 @@
+#include <cmath>
 #include <cctype>
 #include <random>
 #include <chrono>
+#include <string>
+#include <sstream>
 #include <vector>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <algorithm>
+#include <map>
 
 static unsigned int vertexNumber;
-static unsigned int edgeNumber;
+static uint64_t edgeNumber;
 static unsigned int weightNumber;
 
-std::vector<std::pair<unsigned int, std::vector<unsigned int>>> possibleEdges;
+//Les poids tirés sont des entiers de 1 à WEIGHT_MAX, les lois corrélées s'écartent d'au plus WEIGHT_NOISE de leur base
+constexpr int64_t WEIGHT_MAX = 300;
+constexpr int64_t WEIGHT_NOISE = 30;
 
-void genWeights(std::ofstream& stream, const unsigned int vertexID)
+//Générateur pseudo aléatoire xoshiro256**, initialisé avec splitmix64. Contrairement aux distributions de <random>,
+//dont les résultats dépendent de la bibliothèque standard, une même graine donne le même graphe partout
+class Random
 {
-	std::random_device device;
-	std::uniform_int_distribution<unsigned int> distr (vertexID%100, 300);
+public:
+	explicit Random(uint64_t seed)
+	{
+		for (uint64_t& s: m_state)
+		{
+			seed += 0x9E3779B97F4A7C15ull;
+			uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			s = z ^ (z >> 31);
+		}
+	}
+
+	uint64_t next(void)
+	{
+		const uint64_t ret = rotl(m_state[1] * 5, 7) * 9;
+		const uint64_t t = m_state[1] << 17;
+
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= t;
+		m_state[3] = rotl(m_state[3], 45);
+
+		return ret;
+	}
+
+	//Entier uniforme dans [0, bound[ (bound > 0). Les tirages en dessous de 2^64 mod bound sont refusés pour que
+	//le résultat ne favorise aucune valeur. Avec des entiers de 128 bits, le résultat est le poids fort de r*bound
+	//(méthode de Lemire) et le modulo n'est calculé que dans les rares cas où un tirage peut être refusé
+	uint64_t below(const uint64_t bound)
+	{
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 product = (unsigned __int128)next() * bound;
+
+		if ((uint64_t)product < bound)
+		{
+			const uint64_t threshold = (0 - bound) % bound;
+
+			while ((uint64_t)product < threshold)
+				product = (unsigned __int128)next() * bound;
+		}
+
+		return (uint64_t)(product >> 64);
+#else
+		const uint64_t threshold = (0 - bound) % bound;
+		uint64_t r;
+
+		do
+			r = next();
+		while (r < threshold);
+
+		return r % bound;
+#endif
+	}
+
+	//Entier uniforme dans [min, max]
+	uint64_t between(const uint64_t min, const uint64_t max) { return min + below(max - min + 1); }
+
+	//Réel uniforme dans [0, 1[
+	double real(void) { return (double)(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+	static uint64_t rotl(const uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); }
+
+private:
+	uint64_t m_state[4];
+};
+
+//Ecriture du fichier par blocs: les nombres sont convertis à la main dans un buffer, écrit quand il est plein
+class BufferedWriter
+{
+public:
+	explicit BufferedWriter(std::ofstream& stream): m_stream(stream) { m_buffer.reserve(BUFFER_SIZE + 64); }
+	~BufferedWriter(void) { flush(); }
+
+public:
+	BufferedWriter& operator<<(const char c)
+	{
+		m_buffer.push_back(c);
+		return *this;
+	}
+
+	BufferedWriter& operator<<(const std::string& s)
+	{
+		m_buffer.append(s);
+		flushIfFull();
+		return *this;
+	}
+
+	BufferedWriter& operator<<(uint64_t n)
+	{
+		char digits[20];
+		int size = 0;
+
+		do
+		{
+			digits[size++] = (char)('0' + n % 10);
+			n /= 10;
+		} while (n != 0);
+
+		while (size != 0)
+			m_buffer.push_back(digits[--size]);
+
+		flushIfFull();
+		return *this;
+	}
+
+	void flush(void)
+	{
+		m_stream.write(m_buffer.data(), m_buffer.size());
+		m_buffer.clear();
+	}
 
-	for (size_t i = 0; i < weightNumber; ++i)
+private:
+	static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+	void flushIfFull(void)
 	{
-		stream << distr(device);
-		if (i != weightNumber - 1)
-			stream << " ";
+		if (m_buffer.size() >= BUFFER_SIZE)
+			flush();
 	}
+
+private:
+	std::ofstream& m_stream;
+	std::string m_buffer;
+};
+
+//Nombre de paires de sommets
+static uint64_t pairCount(void) { return ((uint64_t)vertexNumber * (vertexNumber - 1)) / 2; }
+
+//count entiers distincts tirés uniformément dans [0, bound[, triés. Les entiers sont tirés avec remise puis les
+//doublons sont supprimés, jusqu'à en avoir assez. Si on en a trop, on en garde count au hasard: la loi de l'ensemble
+//obtenu ne change pas quand on permute [0, bound[, tous les ensembles de count entiers ont donc la même probabilité.
+//Mémoire en O(count), à utiliser avec count <= bound/2 pour que les doublons restent rares
+static std::vector<uint64_t> sampleDistinct(const uint64_t count, const uint64_t bound, Random& random)
+{
+	std::vector<uint64_t> ret;
+	ret.reserve(count + count / 4 + 16);
+
+	while (ret.size() < count)
+	{
+		const uint64_t missing = count - ret.size();
+
+		for (uint64_t i = 0; i < missing + missing / 8 + 16; ++i)
+			ret.emplace_back(random.below(bound));
+
+		std::sort(ret.begin(), ret.end());
+		ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+	}
+
+	//Tirage séquentiel (algorithme S de Knuth): chaque entier est gardé avec la probabilité (nombre encore à garder) /
+	//(nombre restant), ce qui garde count entiers au hasard sans changer leur ordre
+	uint64_t kept = 0;
+	for (uint64_t i = 0; (i < ret.size()) && (kept < count); ++i)
+	{
+		if (random.below(ret.size() - i) < count - kept)
+			ret[kept++] = ret[i];
+	}
+
+	ret.resize(count);
+	return ret;
 }
 
-void genVertices (std::ofstream& stream)
+//Lois des poids d'un sommet:
+// - legacy: chaque poids est tiré dans [numéro % 100, 300] (la loi des premières versions de ggen)
+// - independent: chaque poids est tiré dans [1, WEIGHT_MAX], indépendamment des autres
+// - correlated: les poids d'un sommet sont proches d'une même base, un sommet lourd l'est pour tous les objectifs
+// - anticorrelated: la somme des poids d'un sommet est presque constante, un objectif ne grandit qu'au détriment des
+//   autres. Le front de Pareto est alors grand
+enum class WeightLaw { Legacy, Independent, Correlated, Anticorrelated };
+
+static int64_t clampWeight(const int64_t w) { return std::max<int64_t>(1, std::min(WEIGHT_MAX, w)); }
+
+//weightNumber poids par sommet, sommet par sommet
+std::vector<uint32_t> genWeights(Random& random, const WeightLaw law)
 {
-	for (size_t i = 0; i < vertexNumber; ++i)
+	std::vector<uint32_t> ret;
+	ret.reserve((size_t)vertexNumber * weightNumber);
+
+	for (unsigned int v = 0; v < vertexNumber; ++v)
 	{
-		genWeights(stream, i+1);
-		stream << std::endl;
+		switch (law)
+		{
+			case WeightLaw::Legacy:
+				for (size_t i = 0; i < weightNumber; ++i)
+					ret.emplace_back((uint32_t)random.between((v+1)%100, 300));
+				break;
+
+			case WeightLaw::Independent:
+				for (size_t i = 0; i < weightNumber; ++i)
+					ret.emplace_back((uint32_t)random.between(1, WEIGHT_MAX));
+				break;
+
+			case WeightLaw::Correlated:
+			{
+				const int64_t base = (int64_t)random.between(1, WEIGHT_MAX);
+				for (size_t i = 0; i < weightNumber; ++i)
+					ret.emplace_back((uint32_t)clampWeight(base + (int64_t)random.below(2 * WEIGHT_NOISE + 1) - WEIGHT_NOISE));
+				break;
+			}
+
+			case WeightLaw::Anticorrelated:
+			{
+				//Une somme proche de weightNumber * WEIGHT_MAX / 2, répartie selon des proportions tirées au hasard
+				const int64_t sum = (int64_t)weightNumber * (WEIGHT_MAX / 2) + (int64_t)random.below(2 * WEIGHT_NOISE + 1) - WEIGHT_NOISE;
+				std::vector<int64_t> shares (weightNumber);
+				int64_t sharesSum = 0;
+
+				for (int64_t& share: shares)
+				{
+					share = (int64_t)random.between(1, 1000);
+					sharesSum += share;
+				}
+
+				for (const int64_t share: shares)
+					ret.emplace_back((uint32_t)std::max<int64_t>(1, (sum * share) / sharesSum));
+				break;
+			}
+		}
 	}
+
+	return ret;
 }
 
-void genEdges (std::ofstream& stream)
+//Les paires de sommets sont numérotées ligne par ligne: la paire k relie les sommets j < i avec k = i(i-1)/2 + j
+static uint64_t pairIndex(const uint64_t j, const uint64_t i) { return (i * (i - 1)) / 2 + j; }
+
+//Les arêtes d'un graphe généré: les numéros de leurs paires, triés
+using PairIndices = std::vector<uint64_t>;
+
+//Les paires sont triées, on avance donc de ligne en ligne sans calcul de racine carrée
+class PairDecoder
+{
+public:
+	//Sommets (numérotés à partir de 0) de la paire k, k doit être croissant d'un appel à l'autre
+	std::pair<uint64_t, uint64_t> operator()(const uint64_t k)
+	{
+		while (k >= m_rowBegin + m_row)
+		{
+			m_rowBegin += m_row;
+			++m_row;
+		}
+
+		return std::make_pair(k - m_rowBegin, m_row);
+	}
+
+private:
+	uint64_t m_row = 1;
+	uint64_t m_rowBegin = 0;
+};
+
+//Graphe G(n,m): edgeCount paires distinctes tirées uniformément parmi toutes les paires de sommets. Au delà de la
+//moitié des paires, ce sont les paires sans arête qui sont tirées
+PairIndices genUniformEdges (Random& random, const uint64_t edgeCount)
 {
-	std::random_device device;
+	const uint64_t pairs = pairCount();
+
+	if (edgeCount <= pairs / 2)
+		return sampleDistinct(edgeCount, pairs, random);
 
-	for (size_t i = 0; i < edgeNumber; ++i)
+	const PairIndices missing = sampleDistinct(pairs - edgeCount, pairs, random);
+	PairIndices ret;
+	ret.reserve(edgeCount);
+	size_t next = 0;
+
+	for (uint64_t k = 0; k < pairs; ++k)
 	{
-		std::uniform_int_distribution<unsigned int> distr1 (0, possibleEdges.size()-1);
-		const unsigned int firstVertex = distr1(device);
+		if ((next < missing.size()) && (missing[next] == k))
+			++next;
+		else
+			ret.emplace_back(k);
+	}
 
-		std::uniform_int_distribution<unsigned int> distr2 (0, possibleEdges[firstVertex].second.size()-1);
-		const unsigned int secondVertex = distr2(device);
+	return ret;
+}
 
-		stream << (possibleEdges[firstVertex].first + 1) << " " << (possibleEdges[firstVertex].second[secondVertex] + 1) << std::endl;
+//G(n,m) plus une clique sur cliqueSize sommets tirés au hasard, rangés dans clique
+PairIndices genPlantedClique (Random& random, const uint64_t edgeCount, const uint64_t cliqueSize, std::vector<uint64_t>& clique)
+{
+	PairIndices ret (genUniformEdges(random, edgeCount));
+	clique = sampleDistinct(std::min<uint64_t>(cliqueSize, vertexNumber), vertexNumber, random);
 
-		std::swap(possibleEdges[firstVertex].second[secondVertex],possibleEdges[firstVertex].second.back());
-		possibleEdges[firstVertex].second.pop_back();
+	for (size_t i = 0; i < clique.size(); ++i)
+	{
+		for (size_t j = 0; j < i; ++j)
+			ret.emplace_back(pairIndex(clique[j], clique[i]));
+	}
+
+	std::sort(ret.begin(), ret.end());
+	ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+	return ret;
+}
+
+//Ajoute chaque paire de [first, last[ avec la probabilité p. On saute directement d'une paire gardée à la suivante:
+//l'écart suit une loi géométrique (méthode de Batagelj et Brandes), le coût est proportionnel au nombre de paires gardées
+static void addPairsWithProbability (PairIndices& pairs, const uint64_t first, const uint64_t last, const double p, Random& random)
+{
+	if (p <= 0.0)
+		return;
+
+	if (p >= 1.0)
+	{
+		for (uint64_t k = first; k < last; ++k)
+			pairs.emplace_back(k);
+		return;
+	}
+
+	const double logMiss = std::log(1.0 - p);
+
+	for (uint64_t k = first; ; ++k)
+	{
+		const double skip = std::floor(std::log(1.0 - random.real()) / logMiss);
 
-		if (possibleEdges[firstVertex].second.empty())
+		if (skip >= (double)(last - k))
+			return;
+
+		k += (uint64_t)skip;
+		pairs.emplace_back(k);
+	}
+}
+
+//Modèle à blocs stochastiques: les sommets sont coupés en blocks blocs consécutifs de même taille, deux sommets sont
+//reliés avec la probabilité pIn s'ils sont dans le même bloc, pOut sinon
+PairIndices genStochasticBlocks (Random& random, const uint64_t blocks, const double pIn, const double pOut)
+{
+	auto blockBegin = [blocks](const uint64_t b) { return (b * vertexNumber + blocks - 1) / blocks; };
+	PairIndices ret;
+
+	//Ligne i: les paires (j, i) avec j < i, coupées par bloc de j
+	for (uint64_t i = 1; i < vertexNumber; ++i)
+	{
+		const uint64_t iBlock = (i * blocks) / vertexNumber;
+
+		for (uint64_t b = 0; b <= iBlock; ++b)
 		{
-			std::swap(possibleEdges[firstVertex], possibleEdges.back());
-			possibleEdges.pop_back();
+			const uint64_t first = blockBegin(b);
+			const uint64_t last = std::min(blockBegin(b + 1), i);
+
+			if (first < last)
+				addPairsWithProbability(ret, pairIndex(first, i), pairIndex(last, i), (b == iBlock) ? pIn : pOut, random);
 		}
 	}
+
+	return ret;
+}
+
+//Modèle de Barabási–Albert: on part d'une clique sur attach+1 sommets, puis chaque nouveau sommet est relié à attach
+//sommets distincts choisis avec une probabilité proportionnelle à leur degré. Les degrés suivent une loi de puissance
+PairIndices genBarabasiAlbert (Random& random, const uint64_t attach)
+{
+	const uint64_t seedSize = std::min<uint64_t>(attach + 1, vertexNumber);
+	PairIndices ret;
+	//Chaque sommet y apparaît autant de fois que son degré: un tirage uniforme dans ce tableau suit les degrés
+	std::vector<uint64_t> endpoints;
+
+	for (uint64_t i = 1; i < seedSize; ++i)
+	{
+		for (uint64_t j = 0; j < i; ++j)
+		{
+			ret.emplace_back(pairIndex(j, i));
+			endpoints.emplace_back(j);
+			endpoints.emplace_back(i);
+		}
+	}
+
+	std::vector<uint64_t> targets;
+
+	for (uint64_t v = seedSize; v < vertexNumber; ++v)
+	{
+		targets.clear();
+
+		while (targets.size() < attach)
+		{
+			const uint64_t t = endpoints[random.below(endpoints.size())];
+			if (std::find(targets.begin(), targets.end(), t) == targets.end())
+				targets.emplace_back(t);
+		}
+
+		for (const uint64_t t: targets)
+		{
+			ret.emplace_back(pairIndex(t, v));
+			endpoints.emplace_back(t);
+			endpoints.emplace_back(v);
+		}
+	}
+
+	std::sort(ret.begin(), ret.end());
+	return ret;
+}
+
+//Graphe à la manière des instances p_hat des tests DIMACS pour la clique maximum: chaque sommet a une densité tirée
+//dans [densityMin, densityMax] et deux sommets sont reliés avec la moyenne de leurs densités comme probabilité. Les
+//degrés sont bien plus étalés que dans G(n,m). Toutes les paires sont tirées: à garder pour quelques milliers de sommets
+PairIndices genDimacsLike (Random& random, const double densityMin, const double densityMax)
+{
+	std::vector<double> densities (vertexNumber);
+	for (double& d: densities)
+		d = densityMin + (densityMax - densityMin) * random.real();
+
+	PairIndices ret;
+
+	for (uint64_t i = 1; i < vertexNumber; ++i)
+	{
+		for (uint64_t j = 0; j < i; ++j)
+		{
+			if (random.real() < (densities[i] + densities[j]) / 2.0)
+				ret.emplace_back(pairIndex(j, i));
+		}
+	}
+
+	return ret;
 }
 
 float computeGraphDensity(void)
@@ -66,22 +447,63 @@ float computeGraphDensity(void)
 	return (2.f*floatEdgeNumber) / (floatVertexNumber * floatVertexNumber - floatVertexNumber);
 }
 
-void genFile (std::ofstream& stream)
+//dimacs: les commentaires commencent par 'c' et les arêtes par 'e', comme dans les fichiers DIMACS (voir fileReading.txt)
+void genFile (std::ofstream& stream, const std::vector<uint32_t>& weights, const PairIndices& edges, const std::vector<std::string>& comments, const bool dimacs)
 {
-	stream << "%edges: " << edgeNumber << " density: " << computeGraphDensity() << "\n";
-	stream << "i " << vertexNumber << " w " << weightNumber << "\n";
-	genVertices(stream);
-	genEdges(stream);
+	BufferedWriter writer (stream);
+	const char comment = dimacs ? 'c' : '%';
+
+	std::ostringstream density;
+	density << computeGraphDensity();
+
+	writer << comment << std::string(dimacs ? " edges: " : "edges: ") << edgeNumber << " density: " << density.str() << '\n';
+	for (const std::string& c: comments)
+		writer << comment << ' ' << c << '\n';
+
+	writer << "i " << (uint64_t)vertexNumber << " w " << (uint64_t)weightNumber << '\n';
+
+	for (size_t v = 0; v < vertexNumber; ++v)
+	{
+		for (size_t i = 0; i < weightNumber; ++i)
+		{
+			writer << (uint64_t)weights[v * weightNumber + i];
+			if (i != weightNumber - 1)
+				writer << ' ';
+		}
+		writer << '\n';
+	}
+
+	PairDecoder decode;
+
+	for (const uint64_t k: edges)
+	{
+		const std::pair<uint64_t, uint64_t> e = decode(k);
+
+		if (dimacs)
+			writer << std::string("e ");
+		writer << (e.first + 1) << ' ' << (e.second + 1) << '\n';
+	}
 }
 
-unsigned int getUInt (const char* str)
+//Entier en base 10. Au delà de max, la valeur est refusée et inRange passe à faux
+uint64_t getUInt (const char* str, const uint64_t max, bool& inRange)
 {
-	unsigned int result = 0;
+	const char* number = str;
+	uint64_t result = 0;
 
 	while (std::isdigit(*str))
 	{
+		const uint64_t digit = *str - '0';
+
+		if (result > (max - digit) / 10)
+		{
+			std::cerr << "ERROR: " << number << " is out of range, the maximum is " << max << std::endl;
+			inRange = false;
+			return 0;
+		}
+
 		result *= 10;
-		result += *str - '0';
+		result += digit;
 		++str;
 	}
 
@@ -91,23 +513,70 @@ unsigned int getUInt (const char* str)
 	return result;
 }
 
-//Format: ggen <file path> <weight per vertex> <n vertices> <n edges>
+static const char* USAGE =
+	"arguments are [--seed <seed>] [--weights legacy|independent|correlated|anticorrelated] [--family <family> <options>]\n"
+	"              <file path> <weight per vertex> <n vertices> [<n edges>]\n"
+	"families:\n"
+	"  gnm (default)              <n edges> edges drawn uniformly\n"
+	"  planted [--clique <k>]     gnm plus a clique on k random vertices (default 10)\n"
+	"  sbm [--blocks <b>] [--p-in <p>] [--p-out <q>]\n"
+	"                             stochastic block model (default 10 blocks, p=0.5, q=0.01)\n"
+	"  ba [--attach <k>]          Barabasi-Albert, each new vertex gets k edges (default 5)\n"
+	"  dimacs [--d-min <a>] [--d-max <b>]\n"
+	"                             p_hat like graph in DIMACS syntax (default a=0.25, b=0.75)\n";
+
+//Format: ggen [--seed <seed>] [--weights <loi>] [--family <famille> <options>] <file path> <weight per vertex> <n vertices> [<n edges>]
+//Une même graine donne toujours le même fichier. Sans --seed, la graine est tirée au hasard et affichée. Les familles
+//gnm et planted demandent le nombre d'arêtes, les autres non (voir USAGE)
 int main (int argc, const char** argv)
 {
-	if (argc != 5)
+	std::vector<const char*> arguments;
+	std::map<std::string, std::string> options = { { "--weights", "legacy" }, { "--family", "gnm" }, { "--clique", "10" },
+		{ "--blocks", "10" }, { "--p-in", "0.5" }, { "--p-out", "0.01" }, { "--attach", "5" }, { "--d-min", "0.25" }, { "--d-max", "0.75" } };
+	uint64_t seed = ((uint64_t)std::random_device()() << 32) | std::random_device()();
+	bool argumentsOk = true;
+
+	for (int a = 1; a < argc; ++a)
+	{
+		const std::string arg (argv[a]);
+
+		if ((arg == "--seed") && (a + 1 < argc))
+			seed = std::stoull(argv[++a]);
+		else if ((arg.compare(0, 2, "--") == 0) && (options.count(arg) != 0) && (a + 1 < argc))
+			options[arg] = argv[++a];
+		else if (arg.compare(0, 2, "--") == 0)
+			argumentsOk = false;
+		else
+			arguments.emplace_back(argv[a]);
+	}
+
+	const std::string family = options["--family"];
+	const bool needsEdgeNumber = (family == "gnm") || (family == "planted");
+	const std::map<std::string, WeightLaw> laws = { { "legacy", WeightLaw::Legacy }, { "independent", WeightLaw::Independent },
+		{ "correlated", WeightLaw::Correlated }, { "anticorrelated", WeightLaw::Anticorrelated } };
+
+	argumentsOk = argumentsOk && (laws.count(options["--weights"]) != 0);
+	argumentsOk = argumentsOk && (needsEdgeNumber || (family == "sbm") || (family == "ba") || (family == "dimacs"));
+	argumentsOk = argumentsOk && (arguments.size() == (needsEdgeNumber ? 4u : 3u));
+
+	if (!argumentsOk)
 	{
-		std::cerr << "ERROR: arguments are <file parth> <weight per vertex> <n vertices> <n edges>" << std::endl;
+		std::cerr << "ERROR: " << USAGE;
 		return EXIT_FAILURE;
 	}
 
-	std::ofstream file (argv[1], std::ios::out);
+	//Le nombre d'arêtes d'un grand G(n,m) dépasse 2^32
+	bool inRange = true;
+	weightNumber = (unsigned int)getUInt(arguments[1], std::numeric_limits<unsigned int>::max(), inRange);
+	vertexNumber = (unsigned int)getUInt(arguments[2], std::numeric_limits<unsigned int>::max(), inRange);
+	edgeNumber = needsEdgeNumber ? getUInt(arguments[3], std::numeric_limits<uint64_t>::max(), inRange) : 0;
 
-	weightNumber = getUInt(argv[2]);
-	vertexNumber = getUInt(argv[3]);
-	edgeNumber = getUInt(argv[4]);
+	if (!inRange)
+		return EXIT_FAILURE;
 
+	std::ofstream file (arguments[0], std::ios::out | std::ios::binary);
 
-	const unsigned int maximumNumberOfEdges = (vertexNumber * (vertexNumber-1)) >> 1;
+	const uint64_t maximumNumberOfEdges = (vertexNumber < 2) ? 0 : pairCount();
 
 	if (weightNumber >= 5)
 		std::cout << "WARNING: too many weights leads to the program taking more time to find the best cliques" << std::endl;
@@ -118,23 +587,43 @@ int main (int argc, const char** argv)
 		edgeNumber = maximumNumberOfEdges;
 	}
 
-	std::cout << "INFO: w=" << weightNumber << "   |V|=" << vertexNumber << "   |E|=" << edgeNumber << "   d=" << computeGraphDensity() << std::endl;
+	std::cout << "INFO: w=" << weightNumber << "   |V|=" << vertexNumber << "   family=" << family << "   weights=" << options["--weights"] << "   seed=" << seed << std::endl;
 	std::cout << "Begin generation... took: ";
 
-	possibleEdges.resize(vertexNumber-1);
+	Random random (seed);
 	const auto start = std::chrono::steady_clock::now();
-	for (size_t i = 0; i < vertexNumber-1; ++i)
+
+	//Les poids sont tirés avant les arêtes
+	const std::vector<uint32_t> weights = genWeights(random, laws.at(options["--weights"]));
+	std::vector<std::string> comments = { "ggen --seed " + std::to_string(seed) + " --weights " + options["--weights"] + " --family " + family };
+	PairIndices edges;
+
+	if (family == "gnm")
+		edges = genUniformEdges(random, edgeNumber);
+	else if (family == "planted")
 	{
-		possibleEdges[i].first = i;
-		possibleEdges[i].second.resize(vertexNumber - (i + 1));
-		
-		for (size_t j = 0; j < possibleEdges[i].second.size(); ++j)
-			possibleEdges[i].second[j] = j+i+1;
+		std::vector<uint64_t> clique;
+		edges = genPlantedClique(random, edgeNumber, std::stoull(options["--clique"]), clique);
+
+		std::string members = "planted clique:";
+		for (const uint64_t v: clique)
+			members += " " + std::to_string(v + 1);
+		comments.emplace_back(members);
 	}
+	else if (family == "sbm")
+		edges = genStochasticBlocks(random, std::max<uint64_t>(1, std::stoull(options["--blocks"])), std::stod(options["--p-in"]), std::stod(options["--p-out"]));
+	else if (family == "ba")
+		edges = genBarabasiAlbert(random, std::stoull(options["--attach"]));
+	else
+		edges = genDimacsLike(random, std::stod(options["--d-min"]), std::stod(options["--d-max"]));
+
+	edgeNumber = edges.size();
+	genFile(file, weights, edges, comments, family == "dimacs");
+	file.close();
 
-	genFile(file);
 	const auto end = std::chrono::steady_clock::now();
 	std::cout << std::chrono::duration_cast<std::chrono::seconds>(end - start).count() << "s" << std::endl;
+	std::cout << "INFO: |E|=" << edgeNumber << "   d=" << computeGraphDensity() << std::endl;
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
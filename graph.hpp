@@ -5,469 +5,743 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include <utility>
 #include <iostream>
 #include <algorithm>
+#include <initializer_list>
 
+#include "bitset.hpp"
 #include "weight.hpp"
-
-struct VertexStruct
+#include "paretoArchive.hpp"
+#include "searchStats.hpp"
+
+//Un sommet est identifié par sa position dans le graphe lu (de 0 à |V|-1). Le numéro du sommet dans le fichier
+//n'est gardé que pour l'affichage
+using VertexId = uint32_t;
+using EdgeIndex = size_t;
+
+using IdEdge = std::pair<VertexId, VertexId>;
+using IdEdges = std::vector<IdEdge>;
+
+//Le graphe tel qu'il sort du lecteur de fichier, avant la construction du Graph. Le nombre de poids par sommet n'est
+//connu qu'à la lecture: les poids sont rangés sommet par sommet, weightCount poids chacun. L'adjacence est déjà en
+//CSR (voir Graph): les voisins du sommet v sont adjacency[rowBegin[v]] à adjacency[rowBegin[v+1]-1], triés, sans
+//doublons et sans v lui même
+struct RawGraph
 {
-	unsigned int n;//Vertex number
-	Weight w;//Vertex weight
-
-	VertexStruct(const unsigned int n, const Weight w) { this->n = n;   this->w = w; }
-	VertexStruct(const VertexStruct& vs) { n = vs.n; w = vs.w; std::cout << "VertexStruct copy!\n"; }
-};
+	std::vector<unsigned int> numbers;//Numéro dans le fichier de chaque sommet
+	unsigned int weightCount = 1;
+	std::vector<float> weights;//Poids de chaque sommet
+	std::vector<EdgeIndex> rowBegin;//|V|+1 entrées
+	std::vector<VertexId> adjacency;
 
-using VertexStructContainer = std::vector<std::unique_ptr<VertexStruct>>;
-using VertexStructPtr = const VertexStruct*;
-using VerticesStruct = std::vector<VertexStructPtr>;
-using VertexOrdering = VerticesStruct;
+	float weight(const VertexId v, const size_t column) const { return weights[v * weightCount + column]; }
+	size_t edgeCount(void) const { return adjacency.size() / 2; }
 
-struct Vertex
-{
-	VertexStructPtr vertex;
-	VerticesStruct neighbors;
-	Weight weight(void) const  { return vertex->w; }
-	unsigned int num(void) const { return vertex->n; }
-	Vertex(const VertexStructPtr v = nullptr, const VerticesStruct& n = {}): vertex(v), neighbors(n) {}
+	float density(void) const
+	{
+		const float n = (float)numbers.size();
+		return 2.f*(float)edgeCount() / (n * n - n);
+	}
 };
 
-bool operator==(const Vertex& v1, const VertexStructPtr& v2) { return v1.vertex == v2; }
-bool operator==(const Vertex& v1, const Vertex& v2) { return v1.vertex == v2.vertex; }
-
-using VertexVector = std::vector<Vertex>;
+//Remplit l'adjacence de raw à partir d'une liste d'arêtes sans doublons, en une passe. Les boucles sont ignorées: un
+//sommet n'est pas son propre voisin. Si les arêtes sont triées avec first < second, les lignes le sont déjà
+static void buildAdjacency(RawGraph& raw, const IdEdges& edges)
+{
+	const size_t n = raw.numbers.size();
+	std::vector<EdgeIndex> degrees (n, 0);
 
-//On veut le unique_ptr pour ne pas avoir de copy de VertexStruct si jamais VertexContainer.emplace_back doit allouer
-//un nouveau tableau
-//using Vertex = VertexStruct*;
-//using Vertices = std::vector<Vertex>;
+	for (const IdEdge& e: edges)
+	{
+		if (e.first != e.second)
+		{
+			++degrees[e.first];
+			++degrees[e.second];
+		}
+	}
 
-using Edge = std::pair<VertexStructPtr, VertexStructPtr>;
-using Edges = std::vector<Edge>;
+	raw.rowBegin.resize(n + 1);
+	raw.rowBegin[0] = 0;
+	for (size_t v = 0; v < n; ++v)
+		raw.rowBegin[v+1] = raw.rowBegin[v] + degrees[v];
 
-static void connect(Vertex& a, Vertex& b)
-{
-	auto found = std::find(a.neighbors.begin(), a.neighbors.end(), b.vertex);
+	raw.adjacency.resize(raw.rowBegin[n]);
+	std::vector<EdgeIndex> next (raw.rowBegin.begin(), raw.rowBegin.end() - 1);
 
-	//On connect deux sommets que s'ils ne sont pas déjà connectés
-	if (found == a.neighbors.end())
+	for (const IdEdge& e: edges)
 	{
-		a.neighbors.emplace_back(b.vertex);
-		b.neighbors.emplace_back(a.vertex);
+		if (e.first != e.second)
+		{
+			raw.adjacency[next[e.first]++] = e.second;
+			raw.adjacency[next[e.second]++] = e.first;
+		}
 	}
-}
 
-static Edge makeEdge(Vertex& a, Vertex& b)
-{
-	connect(a, b);
-	return std::make_pair(a.vertex, b.vertex);
+	for (size_t v = 0; v < n; ++v)
+	{
+		auto rowBegin = raw.adjacency.begin() + raw.rowBegin[v];
+		auto rowEnd = raw.adjacency.begin() + raw.rowBegin[v+1];
+
+		if (!std::is_sorted(rowBegin, rowEnd))
+			std::sort(rowBegin, rowEnd);
+	}
 }
 
-struct VertexDegreePair
+//Colonnes de poids utiles pour la recherche: une colonne toujours nulle n'ajoute rien au poids d'une clique et deux
+//colonnes identiques donnent les mêmes sommes, on ne garde donc ni l'une ni l'autre. Une colonne constante non
+//nulle est gardée: elle vaut c*|C| pour une clique C, c'est un vrai objectif. Au moins une colonne est gardée
+static std::vector<unsigned int> significantWeightColumns(const RawGraph& raw)
 {
-	//La référence ne peut pas être constante sinon l'appelle a std::swap ne marche pas dans Initialize
-	const Vertex* v;
-	unsigned int d;
-	//v: Vertex   d: degree
-	VertexDegreePair(const Vertex& ver, const unsigned int d) : v(&ver) { this->d = d; }
-};
-using VertexDegreePairs = std::vector<VertexDegreePair>;
+	const size_t n = raw.numbers.size();
+	std::vector<unsigned int> ret;
 
-static bool tryInsertAndRemoveDominated(const Weight& w, Weights& weights)
-{
-	weights.emplace_back(w);
-	
-	for (size_t i = 0; i < weights.size()-1; ++i)
-	{
-		//Si le poids ajouté est plus petit qu'un autre poids, on supprime l'insertion et
-		//l'algorithme s'arrête là
-		if (w <= weights[i])
+	auto columnIsZero = [&raw, n](const unsigned int c)
 		{
-			weights.pop_back();
-			return false;
-		}
-		//Si le poids ajouté domine un autre poids, on supprime ce poids dominé en gardant le poids que l'on
-		//vient d'ajouter à la fin du tableau
-		else if (w > weights[i])
+			for (VertexId v = 0; v < n; ++v)
+			{
+				if (raw.weight(v, c) != 0.f)
+					return false;
+			}
+			return true;
+		};
+
+	auto sameColumns = [&raw, n](const unsigned int c1, const unsigned int c2)
 		{
-			std::swap(weights.back(), weights[i]);
-			weights.pop_back();
-			std::swap(weights.back(), weights[i]);
-			--i;
-		}
+			for (VertexId v = 0; v < n; ++v)
+			{
+				if (raw.weight(v, c1) != raw.weight(v, c2))
+					return false;
+			}
+			return true;
+		};
+
+	for (unsigned int c = 0; c < raw.weightCount; ++c)
+	{
+		if (columnIsZero(c))
+			continue;
+
+		bool duplicate = false;
+		for (const unsigned int kept: ret)
+			duplicate = duplicate || sameColumns(kept, c);
+
+		if (!duplicate)
+			ret.emplace_back(c);
 	}
 
-	//Si addVertexWeight vaut true, ça veut dire que l'on a pas ajouté le sommet la fonction renvoie donc
-	//false, et inversement si addVertexWeight vaut true
-	return  true;
+	if (ret.empty())
+		ret.emplace_back(0);
+
+	return ret;
 }
 
+//Voisins d'un sommet: une tranche du tableau d'adjacence du graphe
+struct NeighborRange
+{
+	const VertexId* first;
+	const VertexId* last;
+
+	const VertexId* begin(void) const { return first; }
+	const VertexId* end(void) const { return last; }
+	size_t size(void) const { return last - first; }
+	bool empty(void) const { return first == last; }
+};
+
+using VertexIdVector = std::vector<VertexId>;
+
 class Vertices
 {
 public:
-	Vertices(const VertexVector& vertices = {}) : m_vertices(vertices) {}
-	Vertices(const VerticesStruct& vertices)
-	{
-		m_vertices.reserve(vertices.size());
-		for (const VertexStruct* v: vertices)
-			m_vertices.emplace_back(v);
-	}
+	using value_type = VertexId;
 
 public:
-	VertexVector::iterator begin(void) { return m_vertices.begin(); }
-	VertexVector::const_iterator begin(void) const { return m_vertices.begin(); }
+	Vertices(const VertexIdVector& vertices = {}) : m_vertices(vertices) {}
+	Vertices(std::initializer_list<VertexId> vertices) : m_vertices(vertices) {}
+	Vertices(const NeighborRange& neighbors) : m_vertices(neighbors.begin(), neighbors.end()) {}
 
-	VertexVector::iterator end(void) { return m_vertices.end(); }
-	VertexVector::const_iterator end(void) const { return m_vertices.end(); }
+public:
+	VertexIdVector::iterator begin(void) { return m_vertices.begin(); }
+	VertexIdVector::const_iterator begin(void) const { return m_vertices.begin(); }
+
+	VertexIdVector::iterator end(void) { return m_vertices.end(); }
+	VertexIdVector::const_iterator end(void) const { return m_vertices.end(); }
 
-	VertexVector::reference front(void) { return m_vertices.front(); }
-	VertexVector::const_reference front(void) const { return m_vertices.front(); }
+	VertexIdVector::reference front(void) { return m_vertices.front(); }
+	VertexIdVector::const_reference front(void) const { return m_vertices.front(); }
 
-	VertexVector::reference back(void) { return m_vertices.back(); }
-	VertexVector::const_reference back(void) const { return m_vertices.back(); }
+	VertexIdVector::reference back(void) { return m_vertices.back(); }
+	VertexIdVector::const_reference back(void) const { return m_vertices.back(); }
 
-	VertexVector::reference operator[](VertexVector::size_type pos) { return m_vertices[pos]; }
-	VertexVector::const_reference operator[](VertexVector::size_type pos) const { return m_vertices[pos]; }
+	VertexIdVector::reference operator[](VertexIdVector::size_type pos) { return m_vertices[pos]; }
+	VertexIdVector::const_reference operator[](VertexIdVector::size_type pos) const { return m_vertices[pos]; }
 
-	VertexVector::size_type size(void) const noexcept { return m_vertices.size(); }
+	VertexIdVector::size_type size(void) const noexcept { return m_vertices.size(); }
 
 	bool empty(void) const noexcept { return m_vertices.empty(); }
 
 	template<class... Args>
 	void emplace_back(Args&&... args) { m_vertices.emplace_back(std::forward<Args>(args)...); }
-	void reserve(VertexVector::size_type new_cap) { m_vertices.reserve(new_cap); }
-	void pop_back(void) { m_vertices.pop_back(); }
-	void shrink_to_fit(void) { m_vertices.shrink_to_fit(); }
+	//Pour std::back_inserter (intersectSorted, differenceSorted)
+	void push_back(const VertexId v) { m_vertices.push_back(v); }
+	void reserve(VertexIdVector::size_type new_cap) { m_vertices.reserve(new_cap); }
+	void resize(VertexIdVector::size_type count) { m_vertices.resize(count); }
+	void clear(void) noexcept { m_vertices.clear(); }
+	template <class InputIt>
+	VertexIdVector::iterator insert(VertexIdVector::const_iterator pos, InputIt first, InputIt last) { return m_vertices.insert(pos, first, last); }
 
 public:
-	Weight weight(void) const
+	static Vertices unionBetween(const Vertices& V1, const VertexId v)
 	{
-		Weight totalWeight;
+		Vertices finalUnion(V1);
 
-		for (size_t i = 0; i < WEIGHTS_SIZE; ++i)
-			totalWeight[i] = 0;
+		auto found = std::find(finalUnion.begin(), finalUnion.end(), v);
 
-		for (const Vertex& v : m_vertices)
-			totalWeight += v.weight();
+		if (found == finalUnion.end())
+			finalUnion.emplace_back(v);
+		return finalUnion;
+	}
 
-		return totalWeight;
+	//Ajoute v à sa place dans un ensemble trié, s'il n'y est pas déjà
+	void insertSorted(const VertexId v)
+	{
+		auto found = std::lower_bound(m_vertices.begin(), m_vertices.end(), v);
+
+		if ((found == m_vertices.end()) || (*found != v))
+			m_vertices.insert(found, v);
+	}
+
+private:
+	VertexIdVector m_vertices;
+};
+using VerticesVector = std::vector<Vertices>;
+
+//Ordre sur des sommets. En plus de la liste des sommets dans l'ordre, les sommets sont gardés triés par identifiant
+//avec leur rang: le rang d'un sommet se trouve par dichotomie, et ranger un ensemble de sommets dans l'ordre est un
+//tri par rang
+class VertexOrdering
+{
+public:
+	VertexOrdering(void) = default;
+
+	explicit VertexOrdering(const VertexIdVector& order): m_order(order), m_ids(order), m_ranks(order.size())
+	{
+		std::sort(m_ids.begin(), m_ids.end());
+
+		for (size_t k = 0; k < m_order.size(); ++k)
+			m_ranks[std::lower_bound(m_ids.begin(), m_ids.end(), m_order[k]) - m_ids.begin()] = (uint32_t)k;
 	}
 
-	Weights getMaxWeights(void) const
+public:
+	size_t size(void) const { return m_order.size(); }
+	VertexId operator[](const size_t k) const { return m_order[k]; }
+
+	VertexIdVector::const_iterator begin(void) const { return m_order.begin(); }
+	VertexIdVector::const_iterator end(void) const { return m_order.end(); }
+
+	//size() pour un sommet qui n'est pas dans l'ordre
+	uint32_t rank(const VertexId v) const
 	{
-		Weights WMax;
+		auto found = std::lower_bound(m_ids.begin(), m_ids.end(), v);
+		return ((found != m_ids.end()) && (*found == v)) ? m_ranks[found - m_ids.begin()] : (uint32_t)m_order.size();
+	}
 
-		for (const Vertex v : m_vertices)
-			tryInsertAndRemoveDominated(v.weight(), WMax);
-		
-		return WMax;
+	//Range V dans l'ordre, les sommets qui ne sont pas dans l'ordre sont mis à la fin
+	void sort(Vertices& V) const
+	{
+		std::vector<std::pair<uint32_t, VertexId>> ranked;
+		sort(V, ranked);
 	}
 
-	//TODO: améliorer le O(n^2)
-	void orderWith(const VertexOrdering& O)
+	//Pareil avec un tableau de travail fourni par l'appelant, qui garde sa mémoire d'un appel à l'autre
+	void sort(Vertices& V, std::vector<std::pair<uint32_t, VertexId>>& ranked) const
 	{
-		unsigned int OPos = 0;
-		unsigned int VPos = 0;
+		ranked.clear();
+		ranked.reserve(V.size());
 
-		while (VPos < m_vertices.size() && OPos < O.size())
-		{
-			bool found = false;
+		for (const VertexId v: V)
+			ranked.emplace_back(rank(v), v);
 
-			for (size_t j = VPos; j < m_vertices.size(); ++j)
-			{
-				if (m_vertices[j] == O[OPos])
-				{
-					std::swap(m_vertices[VPos++], m_vertices[j]);
-					++OPos;
-					found = true;
-				}
-			}
+		std::sort(ranked.begin(), ranked.end());
 
-			//Si le sommet que l'on veut trier n'est pas présent dans le graphe, on passe au sommet suivant à trier
-			if (!found) ++OPos;
-		}
+		for (size_t k = 0; k < ranked.size(); ++k)
+			V[k] = ranked[k].second;
 	}
 
-	Vertices subSet(const size_t begin, const size_t end)
+private:
+	VertexIdVector m_order;
+	VertexIdVector m_ids;//Les sommets de m_order, triés
+	std::vector<uint32_t> m_ranks;//m_ranks[k]: rang de m_ids[k]
+};
+
+template <size_t D> class Graph;
+template <size_t D> class SubgraphView;
+
+struct VerticesSet
+{
+	VerticesVector set;
+};
+
+using Clique = Vertices;
+template <size_t D>
+using Cliques = ParetoArchive<Clique, D>;
+
+//Clique en cours de construction dans la recherche. Ses sommets forment une liste chaînée persistante: étendre la
+//clique d'un sommet crée un seul noeud qui pointe vers la clique étendue, dont les sommets sont partagés, et le poids
+//total est mis à jour au passage. La clique n'est recopiée dans un Clique que quand on en a besoin
+template <size_t D>
+class PartialClique
+{
+public:
+	PartialClique(void): m_weight(), m_size(0) {}
+
+public:
+	PartialClique<D> extendedWith(const VertexId v, const Weight<D>& w) const
 	{
-		Vertices subset;
-		if (begin <= end)
+		PartialClique<D> ret;
+		ret.m_last = std::make_shared<const Node>(v, m_last);
+		ret.m_weight = m_weight + w;
+		ret.m_size = m_size + 1;
+		return ret;
+	}
+
+	const Weight<D>& weight(void) const { return m_weight; }
+	size_t size(void) const { return m_size; }
+
+	//Les sommets dans l'ordre où ils ont été ajoutés
+	Clique materialize(void) const
+	{
+		Clique ret;
+		ret.reserve(m_size);
+
+		for (const Node* n = m_last.get(); n != nullptr; n = n->parent.get())
+			ret.emplace_back(n->v);
+
+		std::reverse(ret.begin(), ret.end());
+		return ret;
+	}
+
+private:
+	struct Node
+	{
+		VertexId v;
+		std::shared_ptr<const Node> parent;
+
+		Node(const VertexId v, const std::shared_ptr<const Node>& parent): v(v), parent(parent) {}
+	};
+
+private:
+	std::shared_ptr<const Node> m_last;//nullptr pour la clique vide
+	Weight<D> m_weight;
+	size_t m_size;
+};
+template <size_t D>
+using PartialCliques = ParetoArchive<PartialClique<D>, D>;
+
+//Données par sommet, partagées par un graphe et tous ses sous graphes
+template <size_t D>
+struct GraphCore
+{
+	std::vector<unsigned int> numbers;//Numéro dans le fichier
+	Weights<D> weights;
+	//Représentation dense optionnelle de l'adjacence du graphe lu: la ligne v contient les voisins de v. Les voisinages
+	//dans un sous graphe s'obtiennent avec un masque des sommets du sous graphe
+	std::unique_ptr<BitMatrix> dense;
+};
+
+//Le graphe est stocké en CSR (compressed sparse row): les voisins de tous les sommets sont dans un seul tableau
+//d'identifiants, les voisins du sommet m_vertices[k] commencent à m_rowBegin[k]. Chaque ligne est triée.
+//Les sommets sont triés par identifiant, ce qui permet de retrouver la ligne d'un sommet par dichotomie.
+//Chaque sommet a D poids
+template <size_t D>
+class Graph
+{
+public:
+	Graph(void) = default;
+
+	//Construit le graphe lu, une seule fois. Les poids des sommets sont les colonnes columns des poids lus
+	//(columns.size() doit valoir D). L'adjacence de raw est déplacée dans le graphe, sans copie: raw n'a plus d'arêtes
+	Graph(RawGraph& raw, const std::vector<unsigned int>& columns) : m_core(std::make_shared<GraphCore<D>>())
+	{
+		const size_t n = raw.numbers.size();
+
+		m_core->numbers = raw.numbers;
+		m_core->weights.resize(n);
+
+		for (VertexId v = 0; v < n; ++v)
 		{
-			subset.reserve(end - begin + 1);//+1: index depuis 0
+			for (size_t d = 0; d < D; ++d)
+				m_core->weights[v][d] = raw.weight(v, columns[d]);
+		}
 
-			for (size_t i = begin; i <= end; ++i)
-				subset.emplace_back(m_vertices[i]);
+		m_degrees.resize(n);
+		m_vertices.reserve(n);
+		for (size_t v = 0; v < n; ++v)
+		{
+			m_degrees[v] = (unsigned int)(raw.rowBegin[v+1] - raw.rowBegin[v]);
+			m_vertices.emplace_back((VertexId)v);
 		}
-		return subset;
+
+		m_rowBegin = std::move(raw.rowBegin);
+		m_rowBegin.pop_back();
+		m_adjacency = std::move(raw.adjacency);
+		raw.rowBegin.clear();
+		raw.adjacency.clear();
 	}
 
-	void remove(const Vertices& V)
+public:
+	//Sous graphe induit par V (V doit être inclus dans les sommets du graphe), sans copie de l'adjacence
+	SubgraphView<D> operator[](const Vertices& V) const;
+
+	//Retire en une seule passe tous les sommets v tels que removed.test(v) (removed a idCount() bits): les sommets
+	//gardés et leurs voisins gardés sont recopiés vers le début des tableaux, les lignes restent triées. La matrice
+	//d'adjacence dense, partagée avec les autres graphes, n'est pas modifiée
+	void removeVertices(const Bitset& removed)
 	{
-		for (const Vertex& v: V)
+		size_t kept = 0;
+		EdgeIndex offset = 0;
+
+		for (size_t k = 0; k < m_vertices.size(); ++k)
 		{
-			for (size_t i = 0; i < m_vertices.size(); ++i)
+			if (removed.test(m_vertices[k]))
+				continue;
+
+			//Les lignes sont rangées dans l'ordre des sommets: offset <= m_rowBegin[k], on n'écrase rien qui reste à lire
+			const EdgeIndex rowBegin = m_rowBegin[k];
+			const EdgeIndex rowEnd = rowBegin + m_degrees[k];
+			const EdgeIndex newRowBegin = offset;
+
+			for (EdgeIndex e = rowBegin; e < rowEnd; ++e)
 			{
-				if (m_vertices[i] == v)
-				{
-					std::swap(m_vertices[i], m_vertices.back());
-					m_vertices.pop_back();
-					break;
-				}
+				if (!removed.test(m_adjacency[e]))
+					m_adjacency[offset++] = m_adjacency[e];
 			}
+
+			m_vertices[kept] = m_vertices[k];
+			m_rowBegin[kept] = newRowBegin;
+			m_degrees[kept] = (unsigned int)(offset - newRowBegin);
+			++kept;
 		}
+
+		m_vertices.resize(kept);
+		m_rowBegin.resize(kept);
+		m_degrees.resize(kept);
+		m_adjacency.resize(offset);
 	}
 
-	static Vertices unionBetween(const Vertices& V1, const Vertex& v)
+	size_t size(void) const { return m_vertices.size(); }
+	bool empty(void) const { return m_vertices.empty(); }
+
+	//Les identifiants des sommets sont tous plus petits que idCount()
+	size_t idCount(void) const { return m_core->numbers.size(); }
+
+	size_t edgeCount(void) const
 	{
-		Vertices finalUnion(V1);
+		size_t ret = 0;
 
-		auto found = std::find(finalUnion.begin(), finalUnion.end(), v);
+		for (const unsigned int d: m_degrees)
+			ret += d;
 
-		if (found == finalUnion.end())
-			finalUnion.emplace_back(v);
-		return finalUnion;
+		return ret / 2;
 	}
 
-	static Vertices unionBetween(const Vertices& V1, const Vertices& V2)
+	//Sommets du graphe, triés par identifiant
+	const Vertices& getVertices(void) const { return m_vertices; }
+
+	//Voisins de v dans ce graphe (v doit être un sommet du graphe)
+	NeighborRange neighbors(const VertexId v) const
 	{
-		Vertices finalUnion(V1);
-		for (const Vertex& v: V2)
-			finalUnion = unionBetween(finalUnion, v);
-		return finalUnion;
+		const size_t k = position(v);
+		const VertexId* row = m_adjacency.data() + m_rowBegin[k];
+		return { row, row + m_degrees[k] };
 	}
 
-	static Vertices intersectionBetween(const Vertices& V1, const Vertices& V2)
+	bool adjacent(const VertexId a, const VertexId b) const
 	{
-		Vertices finalIntersection;
-		for (const Vertex& v: V1)
+		if (isDense())
+			return m_core->dense->test(a, b);
+
+		const NeighborRange n = neighbors(a);
+		return std::binary_search(n.begin(), n.end(), b);
+	}
+
+	unsigned int number(const VertexId v) const { return m_core->numbers[v]; }
+	const Weight<D>& weight(const VertexId v) const { return m_core->weights[v]; }
+	Weight<D> weight(const Vertices& V) const { return sumOfWeights(V); }
+	Weight<D> weight(const NeighborRange& V) const { return sumOfWeights(V); }
+
+	//Taille en octets de la matrice d'adjacence qu'il faudrait pour ce graphe
+	size_t denseAdjacencyBytes(void) const
+	{
+		const size_t n = m_core->numbers.size();
+		return n * wordCountFor(n) * sizeof(BitsetWord);
+	}
+
+	//La matrice est partagée par tous les sous graphes construits ensuite
+	void buildDenseAdjacency(void)
+	{
+		std::unique_ptr<BitMatrix> dense (new BitMatrix(m_core->numbers.size()));
+
+		for (const VertexId v: m_vertices)
 		{
-			for (size_t i = 0; i < V2.size(); ++i)
-			{
-				if (V2[i] == v)
-					finalIntersection.emplace_back(v);
-			}
+			for (const VertexId n: neighbors(v))
+				dense->set(v, n);
 		}
-		return finalIntersection;
+
+		m_core->dense = std::move(dense);
 	}
 
-private:
-	VertexVector m_vertices;
-};
-using VerticesVector = std::vector<Vertices>;
+	bool isDense(void) const { return m_core->dense != nullptr; }
 
-struct VerticesSet
-{
-	VerticesVector set;
+	//Les fonctions suivantes ne sont utilisables que si isDense() est vrai
 
-	Weights getWeights(void) const
+	Bitset membership(const Vertices& V) const
 	{
-		Weights ret;
-		
-		for (const Vertices& s: set)
-			ret.emplace_back(s.weight());
+		Bitset ret(m_core->dense->size());
+
+		for (const VertexId v: V)
+			ret.set(v);
 
 		return ret;
 	}
 
-	void tryInsertAndRemoveDominated (const Vertices& vs)
+	//N(v) ∩ mask calculé mot par mot, les sommets renvoyés sont triés
+	Vertices neighborsIn(const VertexId v, const Bitset& mask) const
 	{
-		bool insert = true;
+		Vertices ret;
+		ret.reserve(m_core->dense->rowIntersectionCount(v, mask));
+		forEachNeighborIn(v, mask, [&ret](const size_t n) { ret.emplace_back((VertexId)n); });
+		return ret;
+	}
+
+private:
+	size_t position(const VertexId v) const
+	{
+		auto found = std::lower_bound(m_vertices.begin(), m_vertices.end(), v);
+		return ((found != m_vertices.end()) && (*found == v)) ? (found - m_vertices.begin()) : m_vertices.size();
+	}
 
-		for (size_t i = 0; i < set.size() - 1; ++i)
+	template <class Range>
+	Weight<D> sumOfWeights(const Range& V) const
+	{
+		Weight<D> totalWeight;
+
+		for (size_t i = 0; i < D; ++i)
+			totalWeight[i] = 0;
+
+		for (const VertexId v : V)
+			totalWeight += weight(v);
+
+		return totalWeight;
+	}
+
+	template <class F>
+	void forEachNeighborIn(const VertexId v, const Bitset& mask, F f) const
+	{
+		const BitsetWord* row = m_core->dense->row(v);
+		const BitsetWord* maskWords = mask.data();
+
+		for (size_t i = 0; i < mask.wordCount(); ++i)
 		{
-			//Si le poids ajouté est plus petit qu'un autre poids, on supprime l'insertion et
-			//l'algorithme s'arrête là
-			if (vs.weight() <= set[i].weight())
-			{
-				insert = false;
-				break;
-			}
-			//Si le poids ajouté domine un autre poids, on supprime ce poids dominé en gardant le poids que l'on
-			//vient d'ajouter à la fin du tableau
-			else if (vs.weight() > set[i].weight())
+			BitsetWord w = row[i] & maskWords[i];
+
+			while (w != 0)
 			{
-				std::swap(set.back(), set[i]);
-				set.pop_back();
-				--i;
+				f(i * BITSET_WORD_BITS + lowestBit(w));
+				w &= w - 1;
 			}
 		}
-
-		if (insert)
-			set.emplace_back(vs);
 	}
-};
 
-using Clique = Vertices;
-using Cliques = VerticesSet;
+private:
+	std::shared_ptr<GraphCore<D>> m_core;
+	Vertices m_vertices;//Les sommets, triés
+	std::vector<EdgeIndex> m_rowBegin;//Début des voisins de m_vertices[k] dans m_adjacency
+	std::vector<unsigned int> m_degrees;//Nombre de voisins de m_vertices[k]
+	std::vector<VertexId> m_adjacency;//Les voisins de tous les sommets
+};
 
-class Graph
+//Premier élément de [first, last) supérieur ou égal à v: on avance par bonds qui doublent à chaque fois jusqu'à
+//dépasser v, puis on cherche par dichotomie dans le dernier bond. Le coût dépend de la distance parcourue et pas de
+//la taille de la suite, ce qui permet de parcourir une longue suite en sautant les parties inutiles
+template <class Iterator>
+static Iterator gallop(Iterator first, const Iterator last, const VertexId v)
 {
-public:
-	Graph(const Vertices& vertices = {}, const Edges& edges = {}) : m_vertices(vertices), m_edges(edges) {}
+	size_t step = 1;
 
-public:
-	Graph operator[](const Vertices& V) const
+	while ((last - first > (std::ptrdiff_t)step) && (first[step] < v))
 	{
-		Graph ret(V);
-		ret.m_edges.reserve((V.size() * (V.size()-1))/2);
+		first += step;
+		step *= 2;
+	}
 
-		//Dans le nouveau graphe, les sommets n'ont encore aucun voisin car on a pas ajouté les arrêtes. Il faut donc les supprimer
-		for (Vertex& v : ret.m_vertices)
-			v.neighbors.clear();
+	return std::lower_bound(first, (last - first > (std::ptrdiff_t)step) ? first + step + 1 : last, v);
+}
 
-		for(const Edge& e: m_edges)
-		{
-			bool findFirst = false;
-			bool findSecond = false;
+//Vrai si une suite est assez petite devant l'autre pour qu'il soit plus rapide de chercher ses éléments par bonds
+//dans l'autre que de fusionner les deux suites
+static bool isSkewed(const size_t small, const size_t large)
+{
+	size_t log2Large = 1;
+	while ((size_t(1) << log2Large) < large)
+		++log2Large;
 
-			size_t posFirst = 0;
-			size_t posSecond = 0;
+	return small * log2Large < small + large;
+}
 
-			for (size_t i = 0; i < ret.m_vertices.size(); ++i)
-			{
-				if (ret.m_vertices[i] == e.first)
-				{
-					findFirst = true;
-					posFirst = i;
-				}
-				else if (ret.m_vertices[i] == e.second)
-				{
-					posSecond = i;
-					findSecond = true;
-				}
-			
-				if (findFirst && findSecond)
-				{
-					ret.m_edges.emplace_back(makeEdge(ret.m_vertices[posFirst],ret.m_vertices[posSecond]));
-					break;
-				}
-			}
-		}
-		ret.m_edges.shrink_to_fit();
-		return ret;
-	}
+//Intersection de deux suites triées. Quand l'une est beaucoup plus courte que l'autre, on cherche ses éléments
+//par bonds dans l'autre plutôt que de parcourir les deux suites
+template <class Range1, class Range2>
+static void intersectSorted(const Range1& small, const Range2& large, Vertices& out)
+{
+	if (small.size() > large.size())
+		return intersectSorted(large, small, out);
 
-	VertexDegreePairs computeDegrees(void) const
+	if (isSkewed(small.size(), large.size()))
 	{
-		VertexDegreePairs ret;	ret.reserve(m_vertices.size());
+		auto it = large.begin();
 
-		for (const Vertex& v : m_vertices)
-			ret.emplace_back(v, v.neighbors.size());
+		for (const VertexId v: small)
+		{
+			it = gallop(it, large.end(), v);
 
-		return ret;
+			if (it == large.end())
+				break;
+			if (*it == v)
+				out.emplace_back(v);
+		}
 	}
+	else
+		std::set_intersection(small.begin(), small.end(), large.begin(), large.end(), std::back_inserter(out));
+}
 
-	void removeVertex(const Vertex& v)
+//V1 \ V2 pour deux suites triées
+template <class Range1, class Range2>
+static void differenceSorted(const Range1& V1, const Range2& V2, Vertices& out)
+{
+	//Peu d'éléments à enlever: on recopie les morceaux de V1 entre deux éléments de V2
+	if (isSkewed(V2.size(), V1.size()))
 	{
-		//D'abord on cherche le sommet dans le graphe
-		size_t vPosInVertices = 0;
+		auto it = V1.begin();
 
-		for (size_t i = 0; i < m_vertices.size(); ++i)
+		for (const VertexId v: V2)
 		{
-			if (m_vertices[i] == v)
-			{
-				vPosInVertices = i;
-				break;
-			}
+			auto found = gallop(it, V1.end(), v);
+			out.insert(out.end(), it, found);
+			it = ((found != V1.end()) && (*found == v)) ? found + 1 : found;
 		}
 
-		if (vPosInVertices < m_vertices.size())
-		{
-			Vertex& vertexToRemove = m_vertices[vPosInVertices];
-			Vertex saveOfLastVertex = m_vertices.back();
+		out.insert(out.end(), it, V1.end());
+	}
+	else
+		std::set_difference(V1.begin(), V1.end(), V2.begin(), V2.end(), std::back_inserter(out));
+}
 
-			//Puis on le supprime de tous ses voisins
-			for (const VertexStructPtr& n: vertexToRemove.neighbors)
-			{
-				//On recherche le voisin dans l'ensemble des sommets
-				//TODO: voir si cette version à besoin d'^etre optimisé
-				for (Vertex& v: m_vertices)
-				{
-					bool removeHappened = false;
-					if (v == n)
-					{
-						for (size_t i = 0; i < v.neighbors.size(); ++i)
-						{
-							if (v.neighbors[i] == vertexToRemove)
-							{
-								std::swap(v.neighbors[i],v.neighbors.back());
-								v.neighbors.pop_back();
-								removeHappened = true;
-								break;
-							}
-						}
-					}
-					if (removeHappened)
-						break;
-				}
-			}
+//Sous graphe induit d'un graphe sans copie: une référence vers le graphe et la liste triée de ses sommets (plus le
+//masque des sommets quand le graphe a une matrice d'adjacence). Les voisins d'un sommet dans le sous graphe sont
+//calculés à la demande à partir de la ligne du sommet dans le graphe
+template <size_t D>
+class SubgraphView
+{
+public:
+	SubgraphView(const Graph<D>& G): SubgraphView(G, G.getVertices(), true) {}
 
-			//Enfin on le supprime du graphe
-			std::swap(m_vertices[vPosInVertices], m_vertices.back());
-			m_vertices.pop_back();
+	//V doit être inclus dans les sommets de G et trié si sorted est vrai
+	SubgraphView(const Graph<D>& G, const Vertices& V, const bool sorted = false): m_graph(&G), m_vertices(V)
+	{
+		WLMC_STATS_TIME(Subgraphs);
+		WLMC_STATS_COUNT(Subgraphs, 1);
+		WLMC_STATS_COUNT(SubgraphVertices, V.size());
+		WLMC_STATS_MAX(SubgraphSize, V.size());
 
-			//Puis on supprime du graphe les arrêtes qui avaient ce sommet
-			for (size_t i = 0; i < m_edges.size(); ++i)
-			{
-				Edge& currentEdge = m_edges[i];
-
-				if ((currentEdge.first == v) || (currentEdge.second == v))
-				{
-					std::swap(m_edges[i], m_edges.back());
-					m_edges.pop_back();
-					--i;
-				}
-			}
-		}
+		if (!sorted)
+			std::sort(m_vertices.begin(), m_vertices.end());
+
+		if (G.isDense())
+			m_mask = G.membership(m_vertices);
 	}
 
+public:
+	//Sous graphe induit par V (V doit être inclus dans les sommets de la vue): c'est une vue sur le même graphe
+	SubgraphView<D> operator[](const Vertices& V) const { return SubgraphView<D>(*m_graph, V); }
+
 	size_t size(void) const { return m_vertices.size(); }
 	bool empty(void) const { return m_vertices.empty(); }
 
+	//Sommets de la vue, triés par identifiant
 	const Vertices& getVertices(void) const { return m_vertices; }
-	const Edges& getEdges(void) const { return m_edges; }
+	const Graph<D>& graph(void) const { return *m_graph; }
+
+	//Voisins de v dans la vue, triés
+	Vertices neighbors(const VertexId v) const
+	{
+		if (isDense())
+			return m_graph->neighborsIn(v, m_mask);
+
+		Vertices ret;
+		intersectSorted(m_graph->neighbors(v), m_vertices, ret);
+		return ret;
+	}
+
+	bool adjacent(const VertexId a, const VertexId b) const { return m_graph->adjacent(a, b); }
+
+	unsigned int number(const VertexId v) const { return m_graph->number(v); }
+	const Weight<D>& weight(const VertexId v) const { return m_graph->weight(v); }
+	Weight<D> weight(const Vertices& V) const { return m_graph->weight(V); }
+
+	bool isDense(void) const { return m_graph->isDense(); }
+	Bitset membership(const Vertices& V) const { return m_graph->membership(V); }
+	Vertices neighborsIn(const VertexId v, const Bitset& mask) const { return m_graph->neighborsIn(v, mask); }
 
 private:
-	Edges		m_edges;//Les arrêtes
-	Vertices	m_vertices;//Les sommets
+	const Graph<D>* m_graph;
+	Vertices m_vertices;//triés
+	Bitset m_mask;//Seulement si le graphe a une matrice d'adjacence
 };
 
-std::ostream& operator<< (std::ostream& stream, const Vertex& v)
-{
-	stream << "(" << v.num() << ", " << v.weight() << ")";
-	return stream;
-}
+template <size_t D>
+SubgraphView<D> Graph<D>::operator[](const Vertices& V) const { return SubgraphView<D>(*this, V); }
 
-std::ostream& operator<< (std::ostream& stream, const Edge& edge)
+//Poids d'un ensemble de sommets avec toutes les colonnes lues dans le fichier, même celles qui n'ont pas servi
+//à la recherche
+static std::vector<float> fileWeight(const RawGraph& raw, const Vertices& vs)
 {
-	stream << edge.first << " -- " << edge.second;
-	return stream;
+	std::vector<float> ret (raw.weightCount, 0.f);
+
+	for (const VertexId v: vs)
+	{
+		for (size_t c = 0; c < raw.weightCount; ++c)
+			ret[c] += raw.weight(v, c);
+	}
+
+	return ret;
 }
 
-std::ostream& operator<< (std::ostream& stream, const Vertices& vs)
+//Les sommets sont affichés avec leur numéro et leurs poids dans le fichier
+std::ostream& printVertices (std::ostream& stream, const RawGraph& raw, const Vertices& vs)
 {
-	std::cout << "{ ";
+	stream << "{ ";
 	for (size_t i = 0; i < vs.size(); ++i)
 	{
-		std::cout << vs[i];
+		stream << "(" << raw.numbers[vs[i]] << ", ";
+		printWeight(stream, raw.weights.data() + vs[i] * raw.weightCount, raw.weightCount) << ")";
 		if (i < vs.size()-1)
-			std::cout << " | ";
+			stream << " | ";
 	}
-	std::cout << "}   weight: " << vs.weight();
+	stream << "}   weight: ";
+	printWeight(stream, fileWeight(raw, vs).data(), raw.weightCount);
 
 	return stream;
 }
 
-std::ostream& operator<< (std::ostream& stream, const VerticesSet& vs)
+std::ostream& printVerticesSet (std::ostream& stream, const RawGraph& raw, const VerticesSet& vs)
 {
 	for (size_t i = 0; i < vs.set.size() - 1; ++i)
-		stream << vs.set[i] << std::endl;
+		printVertices(stream, raw, vs.set[i]) << std::endl;
 
-	stream << vs.set[vs.set.size() - 1];
+	printVertices(stream, raw, vs.set[vs.set.size() - 1]);
 
 	return stream;
 }
 
-#endif
\ No newline at end of file
+#endif
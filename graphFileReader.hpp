@@ -1,258 +1,583 @@
 #ifndef GRAPH_FILE_READER_HPP
 #define GRAPH_FILE_READER_HPP
 
-#include <cctype>
+#include <array>
 #include <chrono>
 #include <string>
+#include <thread>
 #include <cstring>
-#include <fstream>
+#include <limits>
 
 #include "graph.hpp"
+#include "mappedFile.hpp"
+#include "graphSnapshot.hpp"
+
+//En dessous, un morceau de fichier ne vaut pas le lancement d'un thread
+constexpr size_t MIN_EDGE_CHUNK_BYTES = 1 << 20;
+//Pareil pour un morceau du tableau des arêtes à trier
+constexpr size_t MIN_EDGE_SORT_CHUNK = 1 << 16;
+
+//Nombre de bits traités par passe du tri des arêtes
+constexpr unsigned int EDGE_RADIX_BITS = 8;
+constexpr size_t EDGE_RADIX_BUCKETS = size_t(1) << EDGE_RADIX_BITS;
+
+//Case de la table des identifiants pour un numéro qui n'est pas celui d'un sommet
+constexpr VertexId NO_VERTEX = std::numeric_limits<VertexId>::max();
+//La table des identifiants est indexée directement par les numéros lus tant que le plus grand ne dépasse pas ce
+//multiple du nombre de numéros lus (ceux de la ligne 'i' et ceux des arêtes)
+constexpr size_t MAX_DIRECT_ID_TABLE_SPREAD = 4;
+
+//Arête telle qu'elle est écrite dans le fichier: les numéros de ses deux sommets
+using FileEdge = std::pair<unsigned int, unsigned int>;
+using FileEdges = std::vector<FileEdge>;
+
+//Tableaux intermédiaires de la lecture d'un fichier texte. Un GraphFileReader sans GraphReadBuffers a les siens et les
+//libère dès qu'ils ne servent plus. Ceux passés par l'appelant sont seulement vidés: ils gardent leur mémoire pour le
+//fichier suivant (un par thread en mode --batch), au prix de la garder entre deux lectures
+struct GraphReadBuffers
+{
+	FileEdges fileEdges;//Arêtes telles qu'elles sont lues
+	std::vector<unsigned int> edgeNumbers;//Numéros des arêtes au delà de la ligne 'i', si la table n'est pas directe
+	std::vector<VertexId> idOfNumber;//Table des identifiants
+	IdEdges idEdges;//Arêtes par identifiants
+	IdEdges sortScratch;//Tableau de travail du tri des arêtes
+};
 
-constexpr unsigned int LINE_BUFFER_SIZE = 127;
+//Les fonctions suivantes lisent le texte entre p et end sans jamais dépasser end: le fichier projeté n'a pas de
+//'\0' final
 
-class GraphFileReader
+static bool isBlank(const char c) { return (c == ' ') || (c == '\t') || (c == '\r'); }
+static bool isDigit(const char c) { return (unsigned char)(c - '0') < 10; }
+static bool isCommentStart(const char c) { return (c == '%') || (c == 'c') || (c == 'n'); }
+
+static const char* skipBlanks(const char* p, const char* end)
 {
-	public:
-		GraphFileReader(const std::string& path): m_stream(path), m_path(path)
+	while ((p != end) && isBlank(*p))
+		++p;
+	return p;
+}
+
+//Début de la ligne suivante
+static const char* nextLine(const char* p, const char* end)
+{
+	const char* newLine = (const char*)std::memchr(p, '\n', end - p);
+	return (newLine != nullptr) ? newLine + 1 : end;
+}
+
+//Passe les lignes vides et les commentaires, renvoie le début de la première autre ligne
+static const char* skipCommentLines(const char* p, const char* end)
+{
+	for (;;)
+	{
+		p = skipBlanks(p, end);
+
+		if (p == end)
+			return end;
+		else if (*p == '\n')
+			++p;
+		else if (isCommentStart(*p))
+			p = nextLine(p, end);
+		else
+			return p;
+	}
+}
+
+static bool isEndOfLine(const char* p, const char* end) { return (p == end) || (*p == '\n'); }
+
+//Lit un entier non signé et avance p après son dernier chiffre, renvoie false si p n'est pas sur un chiffre. Quand
+//il reste au moins 8 octets, les chiffres sont traités 8 par 8 dans un entier de 64 bits (SWAR): un masque donne le
+//nombre de chiffres en tête, puis trois multiplications les convertissent tous à la fois
+static bool parseUInt(const char*& p, const char* end, unsigned int& out)
+{
+	if ((p == end) || !isDigit(*p))
+		return false;
+
+	uint64_t ret = 0;
+
+	while (end - p >= 8)
+	{
+		uint64_t chunk;
+		std::memcpy(&chunk, p, 8);
+
+		//Un octet est un chiffre si ses 4 bits de poids fort valent 3 et si ses 4 bits de poids faible sont < 10
+		const uint64_t highNibbles = (chunk ^ 0x3030303030303030ull) & 0xF0F0F0F0F0F0F0F0ull;
+		const uint64_t lowOverflow = ((chunk & 0x0F0F0F0F0F0F0F0Full) + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull;
+		const uint64_t notDigits = highNibbles | lowOverflow;
+		const unsigned int digits = (notDigits == 0) ? 8 : (lowestBit(notDigits) / 8);
+
+		if (digits == 0)
+			break;
+
+		//Les chiffres lus sont placés en poids fort: les octets libérés valent 0 et jouent le rôle de zéros en tête.
+		//Le premier caractère est l'octet de poids faible (little endian)
+		uint64_t value = (chunk & 0x0F0F0F0F0F0F0F0Full) << (8 * (8 - digits));
+		value = (value * 10) + (value >> 8);
+		value = (((value & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) + (((value >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+
+		static const uint64_t powersOf10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+		ret = ret * powersOf10[digits] + value;
+		p += digits;
+
+		if (digits != 8)
 		{
-			if (!m_stream.is_open())
-				throw std::logic_error("ERROR: cannot open '" + path + "'");
-			
-			std::memset((void*)m_lineBuffer,'\0',LINE_BUFFER_SIZE);
+			out = (unsigned int)ret;
+			return true;
 		}
+	}
 
-		//TODO: faire une petite gestion des erreurs dans le parser
-		std::pair<Vertices,Edges> readFile (VertexStructContainer& container)
-		{
-			std::pair<Vertices,Edges> ret;
-			std::vector<Vertex*> vertexStructToVertexPtr (1000000);
-			container.clear();
-			ret.first.reserve(1000000);   ret.second.reserve(1000000);
-			container.resize(vertexStructToVertexPtr.size());
+	while ((p != end) && isDigit(*p))
+	{
+		ret = ret * 10 + (*p - '0');
+		++p;
+	}
 
-			std::cout << "Begin reading... ";
-			auto begin = std::chrono::system_clock::now();
+	out = (unsigned int)ret;
+	return true;
+}
+
+static bool parseFloat(const char*& p, const char* end, float& out)
+{
+	bool foundMinus = false;
+	float INTPart = 0.f;
+	float DECPart = 0.f;
+	float mult = .1f;
+
+	if ((p != end) && (*p == '-'))
+	{
+		++p;
+		foundMinus = true;
+	}
+
+	const char* first = p;
+
+	while ((p != end) && isDigit(*p))
+	{
+		INTPart *= 10.f;
+		INTPart += (float)(*p - '0');
+		++p;
+	}
+
+	if ((p != end) && (*p == '.'))
+		++p;
+
+	while ((p != end) && isDigit(*p))
+	{
+		const float read = (*p - '0') * mult;
+		DECPart += read;
+		mult /= 10.f;
+		++p;
+	}
+
+	if (p == first)
+		return false;
+
+	const float result = INTPart + DECPart;
+	out = foundMinus ? -result : result;
+	return true;
+}
+
+//Appelle f(i) pour chaque morceau i, le morceau 0 dans le thread appelant et les autres dans un thread chacun
+template <class F>
+static void forEachChunk(const size_t chunkCount, F f)
+{
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < chunkCount; ++i)
+		threads.emplace_back(f, i);
+
+	f(0);
 
-			passComment();
-			readLine();
+	for (std::thread& t: threads)
+		t.join();
+}
 
-			if (isVertexInfoLine())
+//Trie les arêtes par (first, second) avec un tri à base (LSD radix sort) stable. Les identifiants sont < n: la clé
+//first*2^bits + second tient sur 2*bits bits, traités EDGE_RADIX_BITS par EDGE_RADIX_BITS. A chaque passe, chaque
+//thread compte les chiffres de son morceau, puis range ses arêtes à partir des places qui lui reviennent. sorted est un
+//tableau de travail, échangé avec edges à chaque passe
+static void radixSortEdges(IdEdges& edges, IdEdges& sorted, const size_t n, const unsigned int threadCount)
+{
+	unsigned int bits = 1;
+	while ((bits < 32) && ((size_t(1) << bits) < n))
+		++bits;
+
+	const size_t size = edges.size();
+	const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, size / MIN_EDGE_SORT_CHUNK));
+	auto chunkBegin = [size, chunkCount](const size_t i) { return (size * i) / chunkCount; };
+	auto key = [bits](const IdEdge& e) { return ((uint64_t)e.first << bits) | e.second; };
+
+	sorted.resize(size);
+	std::vector<std::array<size_t, EDGE_RADIX_BUCKETS>> counts (chunkCount);
+
+	for (unsigned int shift = 0; shift < 2 * bits; shift += EDGE_RADIX_BITS)
+	{
+		forEachChunk(chunkCount, [&](const size_t i)
 			{
-				unsigned int vertexCount = 0;
-				unsigned int weightCount = 1;
-				extractVertexCountAndWeightCount(vertexCount,weightCount);
+				counts[i].fill(0);
+				for (size_t j = chunkBegin(i); j < chunkBegin(i+1); ++j)
+					++counts[i][(key(edges[j]) >> shift) & (EDGE_RADIX_BUCKETS - 1)];
+			});
 
-				if (weightCount != WEIGHTS_SIZE)
-					throw std::logic_error("WLMC is compiled for vertex with " + std::to_string(WEIGHTS_SIZE) + 
-						" weights, but '" + m_path + "' contains vertices with " + std::to_string(weightCount) + " weights");
+		//Une passe où toutes les arêtes ont le même chiffre ne change rien
+		bool singleDigit = false;
+		size_t offset = 0;
 
-				parseVertices(ret.first,container,vertexCount,weightCount,vertexStructToVertexPtr);
+		for (size_t d = 0; d < EDGE_RADIX_BUCKETS; ++d)
+		{
+			const size_t digitBegin = offset;
+
+			for (size_t i = 0; i < chunkCount; ++i)
+			{
+				const size_t count = counts[i][d];
+				counts[i][d] = offset;
+				offset += count;
 			}
-			else
-				parseEdge(ret,container,vertexStructToVertexPtr);
 
-			do
+			singleDigit = singleDigit || (offset - digitBegin == size);
+		}
+
+		if (singleDigit)
+			continue;
+
+		forEachChunk(chunkCount, [&](const size_t i)
 			{
-				readLine();
-				if (*m_lineBufferPtr == '\0')
-					break;
-
-				if (!isCommentLine())
-					parseEdge(ret,container,vertexStructToVertexPtr);
-				
-			} while (!m_stream.eof());
-			auto end = std::chrono::system_clock::now();
+				for (size_t j = chunkBegin(i); j < chunkBegin(i+1); ++j)
+					sorted[counts[i][(key(edges[j]) >> shift) & (EDGE_RADIX_BUCKETS - 1)]++] = edges[j];
+			});
+
+		edges.swap(sorted);
+	}
+}
+
+//Lit les lignes d'arêtes ([e] <numéro> <numéro>) et les commentaires entre p et end, les arêtes sont écrites à
+//partir de out (qui avance). Renvoie nullptr si tout a pu être lu, le début de la première ligne incorrecte sinon
+static const char* parseEdgeLines(const char* p, const char* end, FileEdge*& out)
+{
+	for (;;)
+	{
+		p = skipCommentLines(p, end);
+		if (p == end)
+			return nullptr;
+
+		const char* line = p;
+		unsigned int n1, n2;
 
-			std::cout << "took: " << std::chrono::duration_cast<std::chrono::seconds>(end - begin).count() << "s" << std::endl;
+		if (*p == 'e')
+			p = skipBlanks(p + 1, end);
 
-			ret.first.shrink_to_fit();
-			ret.second.shrink_to_fit();
-			container.shrink_to_fit();
+		if (!parseUInt(p, end, n1))
+			return line;
 
-			const size_t vertices	= ret.first.size();
-			const size_t edges		= ret.second.size();
-			const float density = 2.f*(float)edges / (float)(vertices * vertices - vertices);
+		p = skipBlanks(p, end);
+		if (!parseUInt(p, end, n2))
+			return line;
 
-			std::cout << "|V|=" << vertices << "   |E|=" << edges << "   d=" << density << std::endl;
+		p = skipBlanks(p, end);
+		if (!isEndOfLine(p, end))
+			return line;
 
-			return ret;
+		*out++ = FileEdge(n1, n2);
+	}
+}
+
+class GraphFileReader
+{
+	public:
+		//threadCount = 0: les arêtes sont lues avec autant de threads que de coeurs. buffers: tableaux intermédiaires à
+		//réutiliser, nullptr pour que le lecteur ait les siens
+		GraphFileReader(const std::string& path, const unsigned int threadCount = 0, GraphReadBuffers* buffers = nullptr):
+			m_file(path), m_path(path), m_threadCount(threadCount), m_buffers((buffers != nullptr) ? buffers : &m_ownBuffers)
+		{
+			if (m_threadCount == 0)
+				m_threadCount = std::max(1u, std::thread::hardware_concurrency());
 		}
-	
-	private:
-		bool isVertexInfoLine(void) const { return *m_lineBuffer == 'i'; }
-		//Certains fichier utilise un 'n' pour enregistrer un sommet. Pour l'instant on ne lit pas les sommets de cette façon, mais directement depuis les arrêtes
-		bool isCommentLine(void) const { return (*m_lineBuffer == '%') || (*m_lineBuffer == 'c') || (*m_lineBuffer == 'n'); }
 
-		//retourne true si elle la fin du buffer n'a pas été rencontré
-		bool passWhites(void)
+		//Un graphe enregistré par writeGraphSnapshot est reconnu et chargé directement, sinon le fichier est lu comme
+		//du texte (voir fileReading.txt). verbose: la durée de la lecture et la taille du graphe sont affichées
+		RawGraph readFile (const bool verbose = true)
 		{
-			while (!std::isdigit(*m_lineBufferPtr) && (*m_lineBufferPtr != '-'))
+			if (verbose)
+				std::cout << "Begin reading... ";
+			auto begin = std::chrono::system_clock::now();
+
+			RawGraph raw (isGraphSnapshot(m_file) ? readGraphSnapshot(m_file, m_path) : readTextFile());
+
+			auto end = std::chrono::system_clock::now();
+			m_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+			m_density = raw.density();
+
+			if (verbose)
 			{
-				if ((*m_lineBufferPtr == '\0') || (m_lineBufferPtr - m_lineBuffer) > LINE_BUFFER_SIZE)
-					return false;
-				++m_lineBufferPtr;
+				std::cout << "took: " << m_duration << "ms" << std::endl;
+				std::cout << "|V|=" << raw.numbers.size() << "   |E|=" << raw.edgeCount() << "   d=" << m_density << std::endl;
 			}
 
-			return true;
+			return raw;
 		}
 
-		void readLine(void)
-		{
-			m_stream.getline(m_lineBuffer,LINE_BUFFER_SIZE);
-			m_lineBufferPtr = m_lineBuffer;
-		}
+		//Densité du dernier graphe lu
+		float getDensity(void) const { return m_density; }
+		//Durée de la dernière lecture, en millisecondes
+		long long getDuration(void) const { return m_duration; }
 
-		void passComment(void)
+	private:
+		RawGraph readTextFile (void)
 		{
-			while (m_stream.peek() == '%')
-				m_stream.ignore(std::numeric_limits<std::streamsize>::max(),'\n');
-		};
+			//Sans ligne 'i', chaque sommet a un seul poids qui vaut 1
+			RawGraph raw;
+			unsigned int vertexCount = 0;
 
-		float getFloat(void)
-		{
-			bool foundMinus = false;
-			float result = 0.f;
-			float INTPart = 0.f;
-			float DECPart = 0.f;
-			float mult = .1f;
+			const char* p = skipCommentLines(m_file.begin(), m_file.end());
 
-			if (*m_lineBufferPtr == '-')
+			if ((p != m_file.end()) && (*p == 'i'))
 			{
-				++m_lineBufferPtr;
-				foundMinus = true;
+				unsigned int weightCount = 1;
+				p = parseVertexInfoLine(p, vertexCount, weightCount);
+
+				if ((weightCount == 0) || (weightCount > MAX_WEIGHTS_SIZE))
+					throw std::logic_error("WLMC is compiled for vertices with 1 to " + std::to_string(MAX_WEIGHTS_SIZE) +
+						" weights, but '" + m_path + "' contains vertices with " + std::to_string(weightCount) + " weights");
+
+				raw.weightCount = weightCount;
+
+				p = parseVertices(p, raw, vertexCount);
 			}
 
-			while (std::isdigit(*m_lineBufferPtr))
+			FileEdges& fileEdges = m_buffers->fileEdges;
+			parseEdges(p, fileEdges);
+
+			//Les identifiants des sommets sont donnés dans l'ordre d'apparition: d'abord les sommets de la ligne 'i', puis
+			//ceux des arêtes. Si les numéros lus sont serrés, la table des identifiants est indexée par numéro. Sinon
+			//(par exemple une seule arête "1 4000000000"), les numéros des arêtes au delà de la ligne 'i' sont triés et
+			//dédoublonnés, et un tel numéro est rangé dans la table à la place de son rang parmi eux
+			unsigned int maxNumber = vertexCount;
+			for (const FileEdge& e: fileEdges)
+				maxNumber = std::max(maxNumber, std::max(e.first, e.second));
+
+			const bool direct = (size_t)maxNumber <= MAX_DIRECT_ID_TABLE_SPREAD * ((size_t)vertexCount + 2 * fileEdges.size());
+			std::vector<unsigned int>& edgeNumbers = m_buffers->edgeNumbers;
+			edgeNumbers.clear();
+
+			if (!direct)
 			{
-				INTPart *= 10.f;
-				INTPart += (float)(*m_lineBufferPtr - '0');
-				++m_lineBufferPtr;
+				edgeNumbers.reserve(2 * fileEdges.size());
+				for (const FileEdge& e: fileEdges)
+				{
+					if (e.first > vertexCount)
+						edgeNumbers.emplace_back(e.first);
+					if (e.second > vertexCount)
+						edgeNumbers.emplace_back(e.second);
+				}
+
+				std::sort(edgeNumbers.begin(), edgeNumbers.end());
+				edgeNumbers.erase(std::unique(edgeNumbers.begin(), edgeNumbers.end()), edgeNumbers.end());
 			}
 
-			if (*m_lineBufferPtr == '.')
-				++m_lineBufferPtr;
+			auto slotOf = [direct, vertexCount, &edgeNumbers](const unsigned int number) -> size_t
+				{
+					if (direct || (number <= vertexCount))
+						return number;
 
-			while (std::isdigit(*m_lineBufferPtr))
+					return (size_t)vertexCount + 1 + (std::lower_bound(edgeNumbers.begin(), edgeNumbers.end(), number) - edgeNumbers.begin());
+				};
+
+			std::vector<VertexId>& idOfNumber = m_buffers->idOfNumber;
+			idOfNumber.assign(direct ? (size_t)maxNumber + 1 : (size_t)vertexCount + 1 + edgeNumbers.size(), NO_VERTEX);
+			for (unsigned int number = 1; number <= vertexCount; ++number)
+				idOfNumber[number] = number - 1;
+
+			IdEdges& idEdges = m_buffers->idEdges;
+			idEdges.resize(fileEdges.size());
+			for (size_t i = 0; i < fileEdges.size(); ++i)
 			{
-				const float read = (*m_lineBufferPtr - '0') * mult;
-				DECPart += read;
-				mult /= 10.f;
-				++m_lineBufferPtr;
+				//Deux instructions: l'ordre d'évaluation des arguments d'un appel n'est pas fixé
+				idEdges[i].first = idOfNumberOrNew(fileEdges[i].first, idOfNumber[slotOf(fileEdges[i].first)], raw);
+				idEdges[i].second = idOfNumberOrNew(fileEdges[i].second, idOfNumber[slotOf(fileEdges[i].second)], raw);
 			}
-			
-			result = INTPart + DECPart;
 
-			return foundMinus ? -result : result;
+			release(fileEdges);
+			release(edgeNumbers);
+			release(idOfNumber);
+
+			//Les sommets qui n'apparaissent que dans les arêtes ont un seul poids non nul, qui vaut 1
+			const size_t n = raw.numbers.size();
+			raw.weights.resize(n * raw.weightCount, 0.f);
+			for (size_t v = vertexCount; v < n; ++v)
+				raw.weights[v * raw.weightCount] = 1.f;
+
+			removeDuplicateEdges(idEdges, n);
+			buildAdjacency(raw, idEdges);
+			release(idEdges);
+			return raw;
 		}
 
-		void parseVertexWeights(Vertices& vertices, VertexStructContainer& container, std::vector<Vertex*>& vertexStructToVertexPtr, unsigned int vertexNumber, const unsigned int weightCount)
+		//Un tableau intermédiaire qui ne sert plus est libéré s'il appartient au lecteur, vidé sinon
+		template <class T>
+		void release(std::vector<T>& v) const
 		{
-			Weight w;
+			if (m_buffers == &m_ownBuffers)
+				std::vector<T>().swap(v);
+			else
+				v.clear();
+		}
 
-			for (size_t i = 0; i < weightCount; ++i)
+		//Identifiant du sommet de numéro number, dont la case de la table des identifiants est id. Le sommet est créé
+		//s'il n'existe pas encore
+		static VertexId idOfNumberOrNew(const unsigned int number, VertexId& id, RawGraph& raw)
+		{
+			if (id == NO_VERTEX)
 			{
-				w[i] = getFloat();
-				passWhites();
+				id = (VertexId)raw.numbers.size();
+				raw.numbers.emplace_back(number);
 			}
 
-			findVertexAndEmplaceIfNot(vertexNumber,vertices,container,vertexStructToVertexPtr,w);
+			return id;
 		}
 
-		void parseVertices (Vertices& vertices, VertexStructContainer& container, const unsigned int vertexCount, const unsigned int weightCount, std::vector<Vertex*>& vertexStructToVertexPtr)
+		//Rien ne garantit qu'une arête ne soit pas mise deux fois (par exemple (1,0) et (0,1) sont la même arête et on ne
+		//veut pas la mettre deux fois). Chaque arête est écrite (plus petit identifiant, plus grand identifiant), les
+		//arêtes sont triées, puis les doublons, devenus voisins, sont supprimés. Les boucles sont supprimées
+		void removeDuplicateEdges(IdEdges& edges, const size_t n) const
 		{
-			for (size_t i = 0; i < vertexCount; ++i)
+			size_t kept = 0;
+
+			for (const IdEdge& e: edges)
 			{
-				readLine();
-				parseVertexWeights(vertices,container,vertexStructToVertexPtr, i+1,weightCount);
+				if (e.first != e.second)
+					edges[kept++] = IdEdge(std::min(e.first, e.second), std::max(e.first, e.second));
 			}
+
+			edges.resize(kept);
+
+			radixSortEdges(edges, m_buffers->sortScratch, n, m_threadCount);
+			release(m_buffers->sortScratch);
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+		}
+
+		[[noreturn]] void throwParseError(const char* line, const std::string& expected) const
+		{
+			const size_t lineNumber = 1 + std::count(m_file.begin(), line, '\n');
+			throw std::logic_error("ERROR: '" + m_path + "' line " + std::to_string(lineNumber) + ": expected " + expected);
 		}
 
-		void extractVertexCountAndWeightCount(unsigned int& vertexCount, unsigned int& weightCount)
+		//i <nombre de sommets> [[w] <nombre de poids>]
+		const char* parseVertexInfoLine(const char* p, unsigned int& vertexCount, unsigned int& weightCount) const
 		{
+			const char* line = p;
+			const char* end = m_file.end();
 			weightCount = 1;
 
-			passWhites();
-			vertexCount = extractUInt();
+			p = skipBlanks(p + 1, end);
+			if (!parseUInt(p, end, vertexCount))
+				throwParseError(line, "'i <vertex count> [<weight count>]'");
+
+			//ggen écrit "i <nombre de sommets> w <nombre de poids>"
+			p = skipBlanks(p, end);
+			if ((p != end) && (*p == 'w'))
+				p = skipBlanks(p + 1, end);
+
+			if ((p != end) && isDigit(*p))
+				parseUInt(p, end, weightCount);
 
-			if (passWhites())
-				weightCount = extractUInt();
+			p = skipBlanks(p, end);
+			if (!isEndOfLine(p, end))
+				throwParseError(line, "'i <vertex count> [<weight count>]'");
+
+			return nextLine(p, end);
 		}
 
-		Vertex& findVertexAndEmplaceIfNot(const unsigned int vertexNumber, Vertices& vertices, VertexStructContainer& container, std::vector<Vertex*>& vertexStructToVertexPtr, const Weight w = {1.f})
+		//Une ligne de raw.weightCount poids par sommet, les sommets sont numérotés de 1 à vertexCount
+		const char* parseVertices (const char* p, RawGraph& raw, const unsigned int vertexCount)
 		{
-			//On utilise le numéro du sommet pour trouver sa place dans le graphe, du coup il faut être sûr que le container est assez grand pour contenir tous les sommets
-			if (vertexNumber >= container.size())
-			{
-				container.resize(container.size() + 100000);
-				vertexStructToVertexPtr.resize(container.size());
-			}
-			
-			if (container[vertexNumber].get() == nullptr)
+			const char* end = m_file.end();
+			const unsigned int weightCount = raw.weightCount;
+			const std::string expected = std::to_string(weightCount) + " weight(s) for each of the " + std::to_string(vertexCount) + " vertices";
+
+			raw.numbers.reserve(vertexCount);
+			raw.weights.reserve((size_t)vertexCount * weightCount);
+
+			for (unsigned int i = 0; i < vertexCount; ++i)
 			{
-				container[vertexNumber] = std::unique_ptr<VertexStruct>(new VertexStruct(vertexNumber,w));
-				vertices.emplace_back(container[vertexNumber].get());
-				vertexStructToVertexPtr[vertexNumber] = &vertices.back();
-			}
+				p = skipCommentLines(p, end);
 
-			return *vertexStructToVertexPtr[vertexNumber];
-		}
+				const char* line = p;
 
-		void findEdgeFromVerticesAndEmplaceIfNot(Vertex& v1, Vertex&v2, Edges& edges) const
-		{
-			//Si une arête existe entre ces sommets, alors chacun des sommets à l'autre dans ses voisins. Pour vérifier
-			//si une arrête existe ou pas, il suffit donc de chercher un des sommets dans la liste des voisins de l'autre.
-			//Il n'y a pas besoin de tester les deux listes de voisins que si un sommet est dans les voisins d'un autre
-			//les deux sont forcément voisin l'un de l'autre (voir makeEdge)
-			//Wouah *_*
-			auto found = std::find_if(v1.neighbors.begin(), v1.neighbors.end(),
-				[&v2](const VertexStructPtr& vs)
-				{ return vs == v2; });
-			
-			if (found == v1.neighbors.end())
-				edges.emplace_back(makeEdge(v1,v2));
-		}
+				for (size_t k = 0; k < weightCount; ++k)
+				{
+					float w;
+					p = skipBlanks(p, end);
+					if (!parseFloat(p, end, w))
+						throwParseError(line, expected);
+					raw.weights.emplace_back(w);
+				}
 
-		void parseEdge(std::pair<Vertices,Edges>& pair, VertexStructContainer& container, std::vector<Vertex*>& vertexStructContainer)
-		{
-			//A priori le fichier n'est pas trié, il n'y a donc aucune garantie que le noeud lu n'ait pas
-			//déjà été trouvé, il faut donc le rechercher et le créer s'il n'existe pas
-
-			passWhites();
-			const unsigned int n1 = extractUInt();
-
-			passWhites();
-			const unsigned int n2 = extractUInt();
-			
-			Vertex& v1 = findVertexAndEmplaceIfNot(n1,pair.first,container,vertexStructContainer);
-			Vertex& v2 = findVertexAndEmplaceIfNot(n2,pair.first,container,vertexStructContainer);
-
-			//Une fois que l'on a trouvé les vertex correspondant aux valeurs que l'on a lu du fichier,
-			//il faut vérifier que l'arrête qu'ils forment n'existe pas déjà car rien ne garantit
-			//qu'une arrête ne soit pas mise deux fois (par exemple (1,0) et (0,1) sont la même arrête et on
-			//ne veut pas la mettre deux fois)
-			findEdgeFromVerticesAndEmplaceIfNot(v1,v2,pair.second);
+				p = skipBlanks(p, end);
+				if (!isEndOfLine(p, end))
+					throwParseError(line, expected);
+
+				raw.numbers.emplace_back(i+1);
+				p = nextLine(p, end);
+			}
+
+			return p;
 		}
 
-		unsigned int extractUInt (void)
+		//Le reste du fichier est coupé en morceaux qui commencent en début de ligne, lus chacun par un thread. Une
+		//première passe compte les lignes de chaque morceau, ce qui borne son nombre d'arêtes: le tableau des arêtes
+		//n'est alloué qu'une fois et chaque thread y écrit directement à sa place
+		void parseEdges(const char* p, FileEdges& ret) const
 		{
-			unsigned int ret = 0;
+			const char* end = m_file.end();
+			const size_t bytes = end - p;
+			const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(m_threadCount, bytes / MIN_EDGE_CHUNK_BYTES));
+
+			std::vector<const char*> bounds (chunkCount + 1, end);
+			bounds[0] = p;
+			for (size_t i = 1; i < chunkCount; ++i)
+				bounds[i] = std::max(bounds[i-1], nextLine(p + (bytes * i) / chunkCount - 1, end));
+
+			//La dernière ligne d'un morceau peut ne pas finir par '\n'
+			std::vector<size_t> chunkBegin (chunkCount + 1, 0);
+			forEachChunk(chunkCount, [&](const size_t i) { chunkBegin[i+1] = std::count(bounds[i], bounds[i+1], '\n') + 1; });
+
+			for (size_t i = 0; i < chunkCount; ++i)
+				chunkBegin[i+1] += chunkBegin[i];
+
+			ret.resize(chunkBegin[chunkCount]);
+			std::vector<size_t> chunkSize (chunkCount, 0);
+			std::vector<const char*> errors (chunkCount, nullptr);
+
+			forEachChunk(chunkCount, [&](const size_t i)
+				{
+					FileEdge* out = ret.data() + chunkBegin[i];
+					errors[i] = parseEdgeLines(bounds[i], bounds[i+1], out);
+					chunkSize[i] = out - (ret.data() + chunkBegin[i]);
+				});
+
+			for (size_t i = 0; i < chunkCount; ++i)
+			{
+				if (errors[i] != nullptr)
+					throwParseError(errors[i], "an edge '[e] <vertex number> <vertex number>' or a comment");
+			}
 
-			while (std::isdigit(*m_lineBufferPtr))
+			//Les morceaux sont mis bout à bout dans l'ordre du fichier, à la place des lignes de commentaires
+			size_t edgeCount = chunkSize[0];
+			for (size_t i = 1; i < chunkCount; ++i)
 			{
-				ret *= 10;
-				ret += *m_lineBufferPtr - '0';
-				++m_lineBufferPtr;
+				std::copy(ret.begin() + chunkBegin[i], ret.begin() + chunkBegin[i] + chunkSize[i], ret.begin() + edgeCount);
+				edgeCount += chunkSize[i];
 			}
 
-			return ret;
+			ret.resize(edgeCount);
 		}
 
 	private:
-		std::ifstream m_stream;
+		MappedFile m_file;
 		std::string m_path;
-		char m_lineBuffer [LINE_BUFFER_SIZE];
-		const char* m_lineBufferPtr;
+		unsigned int m_threadCount;
+		float m_density = 0.f;
+		long long m_duration = 0;
+		GraphReadBuffers m_ownBuffers;
+		GraphReadBuffers* m_buffers;
 };
 
 #endif
@@ -0,0 +1,219 @@
+#ifndef GRAPH_SNAPSHOT_HPP
+#define GRAPH_SNAPSHOT_HPP
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+
+#include "graph.hpp"
+#include "mappedFile.hpp"
+
+//Graphe déjà lu, enregistré tel qu'il est en mémoire pour être rechargé sans analyse du texte. Après l'en-tête
+//viennent, chacun aligné sur 8 octets:
+// - les numéros des sommets dans le fichier texte (uint32, vertexCount)
+// - les poids, colonne par colonne (float, weightCount colonnes de vertexCount poids)
+// - le début des lignes du CSR (uint64, vertexCount+1)
+// - les voisins de chaque sommet, triés (uint32, 2*edgeCount)
+//Les valeurs sont écrites dans l'ordre des octets de la machine: byteOrder permet de refuser un fichier écrit par
+//une machine qui n'a pas le même
+constexpr char GRAPH_SNAPSHOT_MAGIC[8] = { 'W', 'L', 'M', 'C', 'G', 'R', 'P', 'H' };
+constexpr uint32_t GRAPH_SNAPSHOT_VERSION = 1;
+constexpr uint32_t GRAPH_SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct GraphSnapshotHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint64_t vertexCount;
+	uint64_t weightCount;
+	uint64_t edgeCount;
+};
+
+static size_t snapshotAligned(const size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+//Vrai si le fichier commence comme un graphe enregistré, quelle que soit sa version
+static bool isGraphSnapshot(const MappedFile& file)
+{
+	return (file.size() >= sizeof(GraphSnapshotHeader)) && (std::memcmp(file.data(), GRAPH_SNAPSHOT_MAGIC, sizeof(GRAPH_SNAPSHOT_MAGIC)) == 0);
+}
+
+//Vérifie que l'adjacence lue est celle d'un graphe simple non orienté, comme celle que construit buildAdjacency: chaque
+//ligne est strictement croissante, sans le sommet lui même, et u est voisin de v si et seulement si v est voisin de u.
+//La recherche (intersections par fusion, matrice dense) suppose tout cela. Pour la symétrie, les sommets v sont
+//parcourus dans l'ordre, et chaque voisin u < v de v doit être le prochain voisin plus grand que u pas encore vu dans
+//la ligne de u. À la fin, tous ces voisins doivent avoir été vus
+static bool isSimpleUndirectedAdjacency(const RawGraph& raw)
+{
+	const size_t n = raw.numbers.size();
+	const std::vector<EdgeIndex>& rowBegin = raw.rowBegin;
+	const std::vector<VertexId>& adjacency = raw.adjacency;
+
+	//Position dans la ligne de u du prochain voisin plus grand que u à retrouver
+	std::vector<EdgeIndex> next (n);
+
+	for (size_t v = 0; v < n; ++v)
+	{
+		next[v] = rowBegin[v + 1];
+
+		for (EdgeIndex e = rowBegin[v]; e < rowBegin[v + 1]; ++e)
+		{
+			const VertexId u = adjacency[e];
+
+			if ((u >= n) || (u == v) || ((e > rowBegin[v]) && (u <= adjacency[e - 1])))
+				return false;
+
+			if ((u > v) && (next[v] == rowBegin[v + 1]))
+				next[v] = e;
+		}
+	}
+
+	for (size_t v = 0; v < n; ++v)
+	{
+		for (EdgeIndex e = rowBegin[v]; (e < rowBegin[v + 1]) && (adjacency[e] < v); ++e)
+		{
+			const VertexId u = adjacency[e];
+
+			if ((next[u] == rowBegin[u + 1]) || (adjacency[next[u]] != v))
+				return false;
+
+			++next[u];
+		}
+	}
+
+	for (size_t v = 0; v < n; ++v)
+	{
+		if (next[v] != rowBegin[v + 1])
+			return false;
+	}
+
+	return true;
+}
+
+//L'adjacence est copiée une fois depuis le fichier projeté, puis déplacée dans le Graph sans autre copie
+static RawGraph readGraphSnapshot(const MappedFile& file, const std::string& path)
+{
+	GraphSnapshotHeader header;
+	std::memcpy(&header, file.data(), sizeof(header));
+
+	if (header.version != GRAPH_SNAPSHOT_VERSION)
+		throw std::logic_error("ERROR: '" + path + "' is a version " + std::to_string(header.version) + " graph snapshot, this WLMC reads version " + std::to_string(GRAPH_SNAPSHOT_VERSION));
+	if (header.byteOrder != GRAPH_SNAPSHOT_BYTE_ORDER)
+		throw std::logic_error("ERROR: '" + path + "' is a graph snapshot written with another byte order");
+	if ((header.weightCount == 0) || (header.weightCount > MAX_WEIGHTS_SIZE))
+		throw std::logic_error("WLMC is compiled for vertices with 1 to " + std::to_string(MAX_WEIGHTS_SIZE) +
+			" weights, but '" + path + "' contains vertices with " + std::to_string(header.weightCount) + " weights");
+
+	//Les sommets et les arêtes occupent chacun au moins 4 octets du fichier: bornés par sa taille, ils ne peuvent pas
+	//faire déborder les calculs de taille qui suivent, même avec un en-tête forgé
+	if ((header.vertexCount > file.size() / sizeof(uint32_t)) || (header.vertexCount > std::numeric_limits<VertexId>::max()) ||
+		(header.edgeCount > file.size() / (2 * sizeof(VertexId))))
+		throw std::logic_error("ERROR: '" + path + "' is a truncated or corrupted graph snapshot");
+
+	const size_t n = (size_t)header.vertexCount;
+	const size_t k = (size_t)header.weightCount;
+	const size_t adjacencySize = 2 * (size_t)header.edgeCount;
+
+	const size_t numbersOffset = snapshotAligned(sizeof(GraphSnapshotHeader));
+	const size_t weightsOffset = numbersOffset + snapshotAligned(n * sizeof(uint32_t));
+	const size_t rowBeginOffset = weightsOffset + snapshotAligned(n * k * sizeof(float));
+	const size_t adjacencyOffset = rowBeginOffset + (n + 1) * sizeof(uint64_t);
+	const size_t size = adjacencyOffset + adjacencySize * sizeof(VertexId);
+
+	if (file.size() != size)
+		throw std::logic_error("ERROR: '" + path + "' is a truncated or corrupted graph snapshot");
+
+	RawGraph raw;
+	raw.weightCount = (unsigned int)k;
+
+	raw.numbers.resize(n);
+	std::memcpy(raw.numbers.data(), file.data() + numbersOffset, n * sizeof(uint32_t));
+
+	//Les poids sont rangés sommet par sommet dans RawGraph (n*k valeurs, peu de chose à côté de l'adjacence)
+	raw.weights.resize(n * k);
+	const float* columns = (const float*)(file.data() + weightsOffset);
+	for (size_t v = 0; v < n; ++v)
+	{
+		for (size_t c = 0; c < k; ++c)
+			raw.weights[v * k + c] = columns[c * n + v];
+	}
+
+	//Les lignes doivent se suivre sans se chevaucher, sinon la recherche lirait hors des tableaux
+	raw.rowBegin.resize(n + 1);
+	const uint64_t* rowBegin = (const uint64_t*)(file.data() + rowBeginOffset);
+	for (size_t v = 0; v <= n; ++v)
+	{
+		if ((v > 0) && (rowBegin[v] < rowBegin[v - 1]))
+			throw std::logic_error("ERROR: '" + path + "' is a truncated or corrupted graph snapshot");
+
+		raw.rowBegin[v] = (EdgeIndex)rowBegin[v];
+	}
+
+	if ((rowBegin[0] != 0) || (rowBegin[n] != adjacencySize))
+		throw std::logic_error("ERROR: '" + path + "' is a truncated or corrupted graph snapshot");
+
+	raw.adjacency.resize(adjacencySize);
+	std::memcpy(raw.adjacency.data(), file.data() + adjacencyOffset, adjacencySize * sizeof(VertexId));
+
+	if (!isSimpleUndirectedAdjacency(raw))
+		throw std::logic_error("ERROR: '" + path + "' is a truncated or corrupted graph snapshot");
+
+	return raw;
+}
+
+static void writeGraphSnapshot(const RawGraph& raw, const std::string& path)
+{
+	std::ofstream stream (path, std::ios::binary);
+	if (!stream.is_open())
+		throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+	const size_t n = raw.numbers.size();
+	const size_t k = raw.weightCount;
+
+	auto write = [&stream](const void* data, const size_t bytes)
+		{
+			stream.write((const char*)data, bytes);
+		};
+
+	//Complète la section qui vient d'être écrite jusqu'au prochain multiple de 8 octets
+	auto pad = [&write](const size_t bytes)
+		{
+			const char zeros[8] = {};
+			write(zeros, snapshotAligned(bytes) - bytes);
+		};
+
+	GraphSnapshotHeader header;
+	std::memcpy(header.magic, GRAPH_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = GRAPH_SNAPSHOT_VERSION;
+	header.byteOrder = GRAPH_SNAPSHOT_BYTE_ORDER;
+	header.vertexCount = n;
+	header.weightCount = k;
+	header.edgeCount = raw.edgeCount();
+	write(&header, sizeof(header));
+	pad(sizeof(header));
+
+	write(raw.numbers.data(), n * sizeof(uint32_t));
+	pad(n * sizeof(uint32_t));
+
+	std::vector<float> column (n);
+	for (size_t c = 0; c < k; ++c)
+	{
+		for (size_t v = 0; v < n; ++v)
+			column[v] = raw.weight((VertexId)v, c);
+		write(column.data(), n * sizeof(float));
+	}
+	pad(n * k * sizeof(float));
+
+	const std::vector<uint64_t> rowBegin (raw.rowBegin.begin(), raw.rowBegin.end());
+	write(rowBegin.data(), rowBegin.size() * sizeof(uint64_t));
+
+	write(raw.adjacency.data(), raw.adjacency.size() * sizeof(VertexId));
+
+	if (!stream.good())
+		throw std::logic_error("ERROR: cannot write '" + path + "'");
+}
+
+#endif
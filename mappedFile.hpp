@@ -0,0 +1,120 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//Fichier projeté en mémoire en lecture seule: le contenu est lu par le système à la demande, sans copie dans un
+//buffer intermédiaire, et peut être parcouru par plusieurs threads à la fois
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& path)
+	{
+#if defined(_MSC_VER)
+		m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+			throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+		LARGE_INTEGER size;
+		GetFileSizeEx(m_file, &size);
+		m_size = (size_t)size.QuadPart;
+
+		//Un fichier vide ne peut pas être projeté
+		if (m_size != 0)
+		{
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			m_data = (m_mapping != nullptr) ? (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+			if (m_data == nullptr)
+			{
+				close();
+				throw std::logic_error("ERROR: cannot map '" + path + "'");
+			}
+		}
+#else
+		m_file = open(path.c_str(), O_RDONLY);
+		if (m_file < 0)
+			throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+		struct stat info;
+		fstat(m_file, &info);
+		m_size = (size_t)info.st_size;
+
+		//Un fichier vide ne peut pas être projeté
+		if (m_size != 0)
+		{
+			void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+			if (data == MAP_FAILED)
+			{
+				close();
+				throw std::logic_error("ERROR: cannot map '" + path + "'");
+			}
+
+			m_data = (const char*)data;
+			//Le fichier est lu du début à la fin
+			madvise(data, m_size, MADV_SEQUENTIAL);
+		}
+#endif
+	}
+
+	~MappedFile(void) { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+	const char* data(void) const { return m_data; }
+	size_t size(void) const { return m_size; }
+
+	const char* begin(void) const { return m_data; }
+	const char* end(void) const { return m_data + m_size; }
+
+private:
+	void close(void)
+	{
+#if defined(_MSC_VER)
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr)
+			CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_file);
+
+		m_mapping = nullptr;
+		m_file = INVALID_HANDLE_VALUE;
+#else
+		if (m_data != nullptr)
+			munmap((void*)m_data, m_size);
+		if (m_file >= 0)
+			::close(m_file);
+
+		m_file = -1;
+#endif
+		m_data = nullptr;
+	}
+
+private:
+#if defined(_MSC_VER)
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+#endif
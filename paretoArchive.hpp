@@ -0,0 +1,114 @@
+#ifndef PARETO_ARCHIVE_HPP
+#define PARETO_ARCHIVE_HPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "weight.hpp"
+
+//Les poids d'un front sont triés par premier objectif décroissant. Seuls les poids dont le premier objectif est
+//supérieur ou égal à w[0] peuvent dominer w: ce sont ceux placés avant dominatingCandidatesEnd(w). Seuls ceux dont
+//le premier objectif est inférieur ou égal à w[0] peuvent être dominés par w: ceux à partir de dominatedCandidatesBegin(w)
+template <size_t D>
+static size_t dominatingCandidatesEnd(const Weights<D>& sorted, const Weight<D>& w)
+{
+	return std::upper_bound(sorted.begin(), sorted.end(), w,
+		[](const Weight<D>& a, const Weight<D>& b) { return a[0] > b[0]; }) - sorted.begin();
+}
+
+template <size_t D>
+static size_t dominatedCandidatesBegin(const Weights<D>& sorted, const Weight<D>& w)
+{
+	return std::lower_bound(sorted.begin(), sorted.end(), w,
+		[](const Weight<D>& a, const Weight<D>& b) { return a[0] > b[0]; }) - sorted.begin();
+}
+
+//Vrai si un poids du front trié est supérieur ou égal à w
+template <size_t D>
+static bool isDominatedBySorted(const Weights<D>& sorted, const Weight<D>& w)
+{
+	const size_t end = dominatingCandidatesEnd(sorted, w);
+
+	for (size_t i = 0; i < end; ++i)
+	{
+		if (w <= sorted[i])
+			return true;
+	}
+
+	return false;
+}
+
+//Ensemble de Pareto: aucun poids de l'ensemble n'est inférieur ou égal à un autre. Le poids de chaque entrée est
+//calculé une seule fois, à l'insertion, et les poids sont rangés à part, triés par premier objectif décroissant
+template <class T, size_t D>
+class ParetoArchive
+{
+public:
+	ParetoArchive(void) = default;
+	ParetoArchive(const Weight<D>& w, const T& value): m_weights({ w }), m_values({ value }) {}
+
+public:
+	size_t size(void) const { return m_values.size(); }
+	bool empty(void) const { return m_values.empty(); }
+
+	const Weight<D>& weight(const size_t i) const { return m_weights[i]; }
+	const T& value(const size_t i) const { return m_values[i]; }
+
+	const Weights<D>& weights(void) const { return m_weights; }
+	const std::vector<T>& values(void) const { return m_values; }
+
+	//Les entrées d'indice >= dominatingCandidatesEnd(w) ne peuvent pas dominer w
+	size_t dominatingCandidatesEnd(const Weight<D>& w) const { return ::dominatingCandidatesEnd(m_weights, w); }
+
+	//Vrai si une entrée a un poids supérieur ou égal à w
+	bool isDominated(const Weight<D>& w) const { return isDominatedBySorted(m_weights, w); }
+
+	//N'insère value que si son poids n'est dominé par aucune entrée, et supprime alors les entrées dominées
+	bool tryInsert(const Weight<D>& w, const T& value)
+	{
+		if (isDominated(w))
+			return false;
+
+		removeDominatedBy(w);
+
+		const size_t pos = ::dominatingCandidatesEnd(m_weights, w);
+		m_weights.insert(m_weights.begin() + pos, w);
+		m_values.insert(m_values.begin() + pos, value);
+		return true;
+	}
+
+	void merge(const ParetoArchive& other)
+	{
+		for (size_t i = 0; i < other.size(); ++i)
+			tryInsert(other.weight(i), other.value(i));
+	}
+
+private:
+	void removeDominatedBy(const Weight<D>& w)
+	{
+		size_t kept = dominatedCandidatesBegin(m_weights, w);
+
+		for (size_t i = kept; i < m_weights.size(); ++i)
+		{
+			if (!(m_weights[i] <= w))
+			{
+				if (i != kept)
+				{
+					m_weights[kept] = m_weights[i];
+					m_values[kept] = std::move(m_values[i]);
+				}
+				++kept;
+			}
+		}
+
+		m_weights.resize(kept);
+		m_values.erase(m_values.begin() + kept, m_values.end());
+	}
+
+private:
+	Weights<D> m_weights;
+	std::vector<T> m_values;
+};
+
+#endif
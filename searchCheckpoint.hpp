@@ -0,0 +1,150 @@
+#ifndef SEARCH_CHECKPOINT_HPP
+#define SEARCH_CHECKPOINT_HPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+//Point de reprise de WLMC: entre deux sommets du premier niveau, la recherche ne garde que le front. Le fichier contient
+//le nombre de sommets du premier niveau déjà traités et le front, dont les cliques sont données par les numéros de
+//leurs sommets dans le fichier du graphe. fingerprint identifie le graphe réduit par initialize (sommets, ordre, poids
+//et voisins): un point de reprise n'est utilisé que pour le graphe et les poids avec lesquels il a été écrit.
+//Après l'en-tête viennent les cliques, chacune sous la forme de sa taille puis des numéros de ses sommets (uint32)
+constexpr char SEARCH_CHECKPOINT_MAGIC[8] = { 'W', 'L', 'M', 'C', 'C', 'K', 'P', 'T' };
+constexpr uint32_t SEARCH_CHECKPOINT_VERSION = 1;
+constexpr uint32_t SEARCH_CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+struct SearchCheckpointHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint64_t fingerprint;
+	uint64_t topLevelCount;
+	uint64_t topLevelFinished;
+	uint64_t cliqueCount;
+};
+
+struct SearchCheckpoint
+{
+	uint64_t fingerprint = 0;
+	uint64_t topLevelCount = 0;
+	uint64_t topLevelFinished = 0;
+	std::vector<std::vector<uint32_t>> cliques;//Numéros des sommets
+};
+
+//Empreinte FNV-1a 64 bits, calculée au fur et à mesure
+class Fingerprint
+{
+public:
+	void add(const void* data, const size_t bytes)
+	{
+		const unsigned char* p = (const unsigned char*)data;
+
+		for (size_t i = 0; i < bytes; ++i)
+		{
+			m_hash ^= p[i];
+			m_hash *= 0x100000001b3ull;
+		}
+	}
+
+	template <class T>
+	void add(const T& value) { add(&value, sizeof(value)); }
+
+	uint64_t value(void) const { return m_hash; }
+
+private:
+	uint64_t m_hash = 0xcbf29ce484222325ull;
+};
+
+static bool fileExists(const std::string& path)
+{
+	std::ifstream stream (path);
+	return stream.is_open();
+}
+
+static SearchCheckpoint readSearchCheckpoint(const std::string& path)
+{
+	std::ifstream stream (path, std::ios::binary);
+	if (!stream.is_open())
+		throw std::logic_error("ERROR: cannot open '" + path + "'");
+
+	SearchCheckpointHeader header;
+	stream.read((char*)&header, sizeof(header));
+
+	if (!stream.good() || (std::memcmp(header.magic, SEARCH_CHECKPOINT_MAGIC, sizeof(SEARCH_CHECKPOINT_MAGIC)) != 0))
+		throw std::logic_error("ERROR: '" + path + "' is not a WLMC checkpoint");
+	if (header.version != SEARCH_CHECKPOINT_VERSION)
+		throw std::logic_error("ERROR: '" + path + "' is a version " + std::to_string(header.version) + " checkpoint, this WLMC reads version " + std::to_string(SEARCH_CHECKPOINT_VERSION));
+	if (header.byteOrder != SEARCH_CHECKPOINT_BYTE_ORDER)
+		throw std::logic_error("ERROR: '" + path + "' is a checkpoint written with another byte order");
+
+	SearchCheckpoint ret;
+	ret.fingerprint = header.fingerprint;
+	ret.topLevelCount = header.topLevelCount;
+	ret.topLevelFinished = header.topLevelFinished;
+
+	for (uint64_t c = 0; c < header.cliqueCount; ++c)
+	{
+		uint32_t size = 0;
+		stream.read((char*)&size, sizeof(size));
+
+		std::vector<uint32_t> clique (stream.good() ? size : 0);
+		stream.read((char*)clique.data(), clique.size() * sizeof(uint32_t));
+
+		if (!stream.good())
+			throw std::logic_error("ERROR: '" + path + "' is a truncated or corrupted checkpoint");
+
+		ret.cliques.emplace_back(std::move(clique));
+	}
+
+	if (ret.topLevelFinished > ret.topLevelCount)
+		throw std::logic_error("ERROR: '" + path + "' is a truncated or corrupted checkpoint");
+
+	return ret;
+}
+
+//Le point de reprise est écrit à côté puis renommé: une interruption pendant l'écriture laisse le précédent intact
+static void writeSearchCheckpoint(const SearchCheckpoint& checkpoint, const std::string& path)
+{
+	const std::string temporaryPath = path + ".tmp";
+
+	{
+		std::ofstream stream (temporaryPath, std::ios::binary);
+		if (!stream.is_open())
+			throw std::logic_error("ERROR: cannot open '" + temporaryPath + "'");
+
+		SearchCheckpointHeader header;
+		std::memcpy(header.magic, SEARCH_CHECKPOINT_MAGIC, sizeof(header.magic));
+		header.version = SEARCH_CHECKPOINT_VERSION;
+		header.byteOrder = SEARCH_CHECKPOINT_BYTE_ORDER;
+		header.fingerprint = checkpoint.fingerprint;
+		header.topLevelCount = checkpoint.topLevelCount;
+		header.topLevelFinished = checkpoint.topLevelFinished;
+		header.cliqueCount = checkpoint.cliques.size();
+		stream.write((const char*)&header, sizeof(header));
+
+		for (const std::vector<uint32_t>& clique: checkpoint.cliques)
+		{
+			const uint32_t size = (uint32_t)clique.size();
+			stream.write((const char*)&size, sizeof(size));
+			stream.write((const char*)clique.data(), clique.size() * sizeof(uint32_t));
+		}
+
+		if (!stream.good())
+			throw std::logic_error("ERROR: cannot write '" + temporaryPath + "'");
+	}
+
+	//std::rename ne remplace pas un fichier existant sous windows
+#if defined(_MSC_VER)
+	std::remove(path.c_str());
+#endif
+	if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+		throw std::logic_error("ERROR: cannot write '" + path + "'");
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef SEARCH_STATS_HPP
+#define SEARCH_STATS_HPP
+
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+//Compteurs et chronomètres de la recherche (wlmc --stats). Ils ne sont compilés qu'avec -DWLMC_STATS (make wlmc-stats):
+//sans cette macro, les macros WLMC_STATS_* ne font rien et la recherche ne paie rien. Chaque thread a ses propres
+//compteurs, sans verrou ni opération atomique, qui ne sont additionnés qu'à l'affichage
+
+enum class StatsCounter
+{
+	Nodes,					//Appels de searchMaxWCliques
+	Branches,				//Sommets de branchement renvoyés par getBranches
+	BranchesPrunedByBound,	//Branches coupées par le test C ∪ {B[i]} + P <= Cmax
+	BranchesPrunedByFront,	//Branches coupées par une clique déjà trouvée par un thread
+	Subgraphs,				//Sous graphes induits construits
+	SubgraphVertices,		//Somme de leurs tailles
+	TopLevelVertices,		//Sommets du premier niveau de WLMC
+	TopLevelSkipped,		//Dont le poids potentiel est dominé par le front avant toute recherche
+	FrontInserts,			//Cliques ajoutées au front
+	FrontEvictions,			//Cliques du front supprimées par une clique qui les domine
+	Count
+};
+
+enum class StatsMax
+{
+	SubgraphSize,		//Taille du plus gros sous graphe induit
+	MaxWeightsSumSize,	//Taille de la plus grosse somme de Minkowski de poids max, avant d'être bornée
+	Count
+};
+
+//Les phases ne s'emboîtent pas, sauf initialize qui contient la construction du sous graphe qu'elle renvoie
+enum class StatsPhase
+{
+	Initialize,
+	GetBranches,
+	Subgraphs,
+	Front,//Lectures et mises à jour du front partagé, attente du verrou comprise
+	Count
+};
+
+struct SearchStats
+{
+	std::array<uint64_t, (size_t)StatsCounter::Count> counters {};
+	std::array<uint64_t, (size_t)StatsMax::Count> maxima {};
+	std::array<std::chrono::steady_clock::duration, (size_t)StatsPhase::Count> durations {};
+
+	void add(const SearchStats& other)
+	{
+		for (size_t i = 0; i < counters.size(); ++i)
+			counters[i] += other.counters[i];
+		for (size_t i = 0; i < maxima.size(); ++i)
+			maxima[i] = std::max(maxima[i], other.maxima[i]);
+		for (size_t i = 0; i < durations.size(); ++i)
+			durations[i] += other.durations[i];
+	}
+
+	uint64_t operator[](const StatsCounter c) const { return counters[(size_t)c]; }
+	uint64_t operator[](const StatsMax m) const { return maxima[(size_t)m]; }
+
+	long long milliseconds(const StatsPhase p) const
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(durations[(size_t)p]).count();
+	}
+};
+
+//Les compteurs de tous les threads qui ont mesuré quelque chose. Ceux d'un thread terminé restent dans la liste
+class SearchStatsRegistry
+{
+public:
+	static SearchStatsRegistry& instance(void)
+	{
+		static SearchStatsRegistry registry;
+		return registry;
+	}
+
+	//Compteurs du thread appelant, créés à sa première mesure
+	static SearchStats& local(void)
+	{
+		thread_local SearchStats* stats = nullptr;
+
+		if (stats == nullptr)
+			stats = instance().create();
+
+		return *stats;
+	}
+
+	//Somme des compteurs de tous les threads. Les threads ne doivent plus rien mesurer
+	SearchStats total(void) const
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		SearchStats ret;
+
+		for (const std::unique_ptr<SearchStats>& stats: m_stats)
+			ret.add(*stats);
+
+		return ret;
+	}
+
+private:
+	SearchStats* create(void)
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_stats.emplace_back(new SearchStats);
+		return m_stats.back().get();
+	}
+
+private:
+	mutable std::mutex m_mutex;
+	std::vector<std::unique_ptr<SearchStats>> m_stats;
+};
+
+//Ajoute à la phase le temps passé entre sa construction et sa destruction
+class StatsPhaseTimer
+{
+public:
+	explicit StatsPhaseTimer(const StatsPhase phase): m_phase(phase), m_start(std::chrono::steady_clock::now()) {}
+	~StatsPhaseTimer(void) { SearchStatsRegistry::local().durations[(size_t)m_phase] += std::chrono::steady_clock::now() - m_start; }
+
+	StatsPhaseTimer(const StatsPhaseTimer&) = delete;
+	StatsPhaseTimer& operator=(const StatsPhaseTimer&) = delete;
+
+private:
+	StatsPhase m_phase;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+static std::ostream& printSearchStats(std::ostream& stream, const SearchStats& stats)
+{
+	const uint64_t subgraphs = stats[StatsCounter::Subgraphs];
+
+	stream << "stats: nodes: " << stats[StatsCounter::Nodes] << "   branches: " << stats[StatsCounter::Branches]
+		<< "   pruned by bound: " << stats[StatsCounter::BranchesPrunedByBound] << "   pruned by front: " << stats[StatsCounter::BranchesPrunedByFront] << "\n";
+	stream << "stats: top level vertices: " << stats[StatsCounter::TopLevelVertices] << "   skipped: " << stats[StatsCounter::TopLevelSkipped] << "\n";
+	stream << "stats: subgraphs: " << subgraphs << "   mean size: " << ((subgraphs != 0) ? (double)stats[StatsCounter::SubgraphVertices] / subgraphs : 0.0)
+		<< "   max size: " << stats[StatsMax::SubgraphSize] << "\n";
+	stream << "stats: max weights sum max size: " << stats[StatsMax::MaxWeightsSumSize] << "\n";
+	stream << "stats: front inserts: " << stats[StatsCounter::FrontInserts] << "   evictions: " << stats[StatsCounter::FrontEvictions] << "\n";
+	stream << "stats: time (all threads) initialize: " << stats.milliseconds(StatsPhase::Initialize) << "ms   getBranches: "
+		<< stats.milliseconds(StatsPhase::GetBranches) << "ms   subgraphs: " << stats.milliseconds(StatsPhase::Subgraphs)
+		<< "ms   front: " << stats.milliseconds(StatsPhase::Front) << "ms" << std::endl;
+
+	return stream;
+}
+
+#if defined(WLMC_STATS)
+#define WLMC_STATS_COUNT(counter, n) (SearchStatsRegistry::local().counters[(size_t)StatsCounter::counter] += (n))
+#define WLMC_STATS_MAX(maximum, n) \
+	(SearchStatsRegistry::local().maxima[(size_t)StatsMax::maximum] = std::max<uint64_t>(SearchStatsRegistry::local().maxima[(size_t)StatsMax::maximum], (n)))
+//Ajoute à la phase le temps passé jusqu'à la fin du bloc courant
+#define WLMC_STATS_TIME(phase) const StatsPhaseTimer statsPhaseTimer (StatsPhase::phase)
+#else
+#define WLMC_STATS_COUNT(counter, n) ((void)0)
+#define WLMC_STATS_MAX(maximum, n) ((void)0)
+#define WLMC_STATS_TIME(phase) ((void)0)
+#endif
+
+#endif
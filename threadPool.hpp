@@ -0,0 +1,314 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+class TaskGroup;
+
+//Groupe de threads avec vol de tâches: chaque thread a sa propre file. Une tâche soumise depuis un thread du groupe
+//est mise dans la file de ce thread, qui prend ses tâches par la fin (la dernière soumise d'abord) pendant que les
+//threads sans travail volent les tâches les plus anciennes, en général les plus grosses, par le début de la file
+class ThreadPool
+{
+	friend class TaskGroup;
+
+public:
+	using Task = std::function<void(void)>;
+
+public:
+	//threadCount = 0: autant de threads que de coeurs
+	ThreadPool(unsigned int threadCount = 0)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+		m_queues.reserve(threadCount);
+		for (unsigned int i = 0; i < threadCount; ++i)
+			m_queues.emplace_back(new TaskQueue);
+
+		m_threads.reserve(threadCount);
+		for (unsigned int i = 0; i < threadCount; ++i)
+			m_threads.emplace_back(&ThreadPool::work, this, i);
+	}
+
+	~ThreadPool(void)
+	{
+		wait();
+
+		{
+			std::lock_guard<std::mutex> lock (m_sleepMutex);
+			m_stop = true;
+		}
+		m_taskAvailable.notify_all();
+
+		for (std::thread& t: m_threads)
+			t.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+public:
+	void submit(Task task) { submit(std::move(task), nullptr); }
+
+	//Attend que toutes les tâches soumises soient terminées (à appeler depuis l'extérieur du groupe)
+	void wait(void)
+	{
+		std::unique_lock<std::mutex> lock (m_sleepMutex);
+		m_allDone.wait(lock, [this] { return m_pending.load() == 0; });
+	}
+
+	unsigned int size(void) const { return (unsigned int)m_threads.size(); }
+
+private:
+	//group: le TaskGroup de la tâche, nullptr pour une tâche soumise directement
+	struct QueuedTask
+	{
+		Task task;
+		const TaskGroup* group;
+	};
+
+	struct TaskQueue
+	{
+		std::mutex mutex;
+		std::deque<QueuedTask> tasks;
+	};
+
+	static ThreadPool*& currentPool(void) { static thread_local ThreadPool* pool = nullptr; return pool; }
+	static size_t& currentWorker(void) { static thread_local size_t worker = 0; return worker; }
+
+	void submit(Task task, const TaskGroup* group)
+	{
+		m_pending.fetch_add(1);
+
+		//Depuis l'extérieur du groupe, les tâches sont réparties entre les files à tour de rôle
+		const size_t queue = (currentPool() == this) ? currentWorker() : (m_nextQueue.fetch_add(1) % m_queues.size());
+
+		{
+			std::lock_guard<std::mutex> lock (m_queues[queue]->mutex);
+			m_queues[queue]->tasks.push_back({ std::move(task), group });
+		}
+
+		//Un thread qui s'endort teste m_queued sous ce verrou: il voit la tâche ou il dort déjà et reçoit la notification
+		std::lock_guard<std::mutex> lock (m_sleepMutex);
+		m_queued.fetch_add(1);
+		m_taskAvailable.notify_one();
+	}
+
+	//Exécute une tâche en attente de group ou d'un de ses sous groupes, prise à la fin d'une file (la file du thread
+	//d'abord). Renvoie false s'il n'y en a pas
+	bool runPendingTaskOf(const TaskGroup* group);
+
+	bool takeTask(Task& task)
+	{
+		if (m_queued.load() == 0)
+			return false;
+
+		const bool isWorker = currentPool() == this;
+		const size_t self = isWorker ? currentWorker() : 0;
+
+		//D'abord la file du thread, par la fin
+		if (isWorker)
+		{
+			TaskQueue& q = *m_queues[self];
+			std::lock_guard<std::mutex> lock (q.mutex);
+
+			if (!q.tasks.empty())
+			{
+				task = std::move(q.tasks.back().task);
+				q.tasks.pop_back();
+				m_queued.fetch_sub(1);
+				return true;
+			}
+		}
+
+		//Puis on vole dans les autres files, par le début
+		for (size_t i = 1; i <= m_queues.size(); ++i)
+		{
+			TaskQueue& q = *m_queues[(self + i) % m_queues.size()];
+			std::lock_guard<std::mutex> lock (q.mutex);
+
+			if (!q.tasks.empty())
+			{
+				task = std::move(q.tasks.front().task);
+				q.tasks.pop_front();
+				m_queued.fetch_sub(1);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void run(Task& task)
+	{
+		task();
+
+		if (m_pending.fetch_sub(1) == 1)
+		{
+			std::lock_guard<std::mutex> lock (m_sleepMutex);
+			m_allDone.notify_all();
+		}
+	}
+
+	void work(const size_t index)
+	{
+		currentPool() = this;
+		currentWorker() = index;
+
+		for (;;)
+		{
+			Task task;
+
+			if (takeTask(task))
+			{
+				run(task);
+				continue;
+			}
+
+			//m_stop n'est mis qu'une fois toutes les tâches terminées (voir le destructeur)
+			std::unique_lock<std::mutex> lock (m_sleepMutex);
+			m_taskAvailable.wait(lock, [this] { return m_stop || (m_queued.load() != 0); });
+			if (m_stop)
+				return;
+		}
+	}
+
+private:
+	std::vector<std::unique_ptr<TaskQueue>> m_queues;
+	std::vector<std::thread> m_threads;
+	std::atomic<size_t> m_pending {0};//Tâches soumises et pas encore terminées
+	std::atomic<size_t> m_queued {0};//Tâches en attente dans les files
+	std::atomic<size_t> m_nextQueue {0};
+	std::mutex m_sleepMutex;
+	std::condition_variable m_taskAvailable;
+	std::condition_variable m_allDone;
+	bool m_stop = false;
+};
+
+//Ensemble de tâches dont on attend la fin. Un groupe créé pendant une tâche d'un autre groupe en est un sous groupe.
+//Le thread qui attend n'exécute que des tâches en attente du groupe ou de ses sous groupes: une tâche sans rapport
+//(une autre étape du premier niveau de WLMC, une branche d'un autre groupe) ne s'empile pas sur la sienne, ce qui
+//borne la pile à la profondeur des groupes. Sans telle tâche, il dort jusqu'à ce que le groupe soit terminé ou
+//qu'une tâche d'un de ses sous groupes soit soumise
+class TaskGroup
+{
+	friend class ThreadPool;
+
+public:
+	TaskGroup(ThreadPool& pool): m_pool(pool), m_parent(currentGroup()) {}
+	~TaskGroup(void) { wait(); }
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+public:
+	void run(ThreadPool::Task task)
+	{
+		m_remaining.fetch_add(1);
+
+		m_pool.submit([task, this]
+			{
+				TaskGroup*& current = currentGroup();
+				TaskGroup* const previous = current;
+				current = this;
+				task();
+				current = previous;
+
+				//Sous le verrou: wait ne peut pas voir le groupe terminé, et le détruire, avant la notification
+				std::lock_guard<std::mutex> lock (m_mutex);
+				if (m_remaining.fetch_sub(1) == 1)
+					m_done.notify_all();
+			}, this);
+
+		//Les groupes parents attendent peut être une tâche à exécuter. Ils existent tant que celui ci existe: chacun
+		//attend la tâche qui a créé son sous groupe
+		for (TaskGroup* g = this; g != nullptr; g = g->m_parent)
+		{
+			std::lock_guard<std::mutex> lock (g->m_mutex);
+			++g->m_submitted;
+			g->m_done.notify_all();
+		}
+	}
+
+	void wait(void)
+	{
+		for (;;)
+		{
+			size_t submitted;
+			{
+				std::lock_guard<std::mutex> lock (m_mutex);
+				if (m_remaining.load() == 0)
+					return;
+				submitted = m_submitted;
+			}
+
+			if (m_pool.runPendingTaskOf(this))
+				continue;
+
+			//Une tâche soumise depuis la lecture de submitted réveille le thread
+			std::unique_lock<std::mutex> lock (m_mutex);
+			m_done.wait(lock, [this, submitted] { return (m_remaining.load() == 0) || (m_submitted != submitted); });
+		}
+	}
+
+private:
+	static TaskGroup*& currentGroup(void) { static thread_local TaskGroup* group = nullptr; return group; }
+
+	bool contains(const TaskGroup* group) const
+	{
+		for (; group != nullptr; group = group->m_parent)
+		{
+			if (group == this)
+				return true;
+		}
+
+		return false;
+	}
+
+private:
+	ThreadPool& m_pool;
+	TaskGroup* const m_parent;//Groupe de la tâche pendant laquelle ce groupe a été créé
+	std::atomic<size_t> m_remaining {0};
+	std::mutex m_mutex;
+	std::condition_variable m_done;
+	size_t m_submitted = 0;//Tâches soumises dans le groupe et ses sous groupes, protégé par m_mutex
+};
+
+inline bool ThreadPool::runPendingTaskOf(const TaskGroup* group)
+{
+	if (m_queued.load() == 0)
+		return false;
+
+	const size_t self = (currentPool() == this) ? currentWorker() : 0;
+	Task task;
+
+	for (size_t i = 0; (i < m_queues.size()) && !task; ++i)
+	{
+		TaskQueue& q = *m_queues[(self + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock (q.mutex);
+
+		if (!q.tasks.empty() && group->contains(q.tasks.back().group))
+		{
+			task = std::move(q.tasks.back().task);
+			q.tasks.pop_back();
+			m_queued.fetch_sub(1);
+		}
+	}
+
+	if (!task)
+		return false;
+
+	run(task);
+	return true;
+}
+
+#endif
@@ -5,113 +5,90 @@
 #include <vector>
 #include <iostream>
 
-constexpr size_t WEIGHTS_SIZE = 3;
+//Le nombre de poids par sommet est un paramètre de template: le solveur est compilé pour chaque nombre de poids
+//de 1 à MAX_WEIGHTS_SIZE et la bonne version est choisie à la lecture du fichier
+constexpr size_t MAX_WEIGHTS_SIZE = 8;
 
-//TODO: peut être passer ça en std::vector ?
-using Weight = std::array<float, WEIGHTS_SIZE>;
-using Weights = std::vector<Weight>;
+//Type à part (et pas un simple std::array) pour que les opérateurs de dominance ci-dessous soient préférés aux
+//comparaisons lexicographiques de std::array
+template <size_t D>
+struct Weight: std::array<float, D> {};
 
-bool operator>(const Weight& w1, const Weight& w2)
-{
-	for (size_t i = 0; i < WEIGHTS_SIZE; ++i)
-	{
-		if (w1[i] <= w2[i])
-			return false;
-	}
-
-	return true;
-}
+template <size_t D>
+using Weights = std::vector<Weight<D>>;
 
-bool operator<= (const Weight& w1, const Weight& w2)
+template <size_t D>
+bool operator>(const Weight<D>& w1, const Weight<D>& w2)
 {
-	for (size_t i = 0; i < WEIGHTS_SIZE; ++i)
-	{
-		if (w1[i] > w2[i])
-			return false;
-	}
+	//Sans sortie anticipée: les D comparaisons sont faites sans branchement
+	bool ret = true;
 
-	return true;
+	for (size_t i = 0; i < D; ++i)
+		ret &= w1[i] > w2[i];
+
+	return ret;
 }
 
-bool operator<= (const Weight& w, const Weights& weights)
+template <size_t D>
+bool operator<= (const Weight<D>& w1, const Weight<D>& w2)
 {
-	for (const Weight& W : weights)
-	{
-		if (w <= W)
-			return true;
-	}
+	bool ret = true;
 
-	return false;
-}
+	for (size_t i = 0; i < D; ++i)
+		ret &= w1[i] <= w2[i];
 
-bool operator<= (const Weights& weights, const Weight& W)
-{
-	for (const Weight& w : weights)
-	{
-		if (!(w <= W))
-			return false;
-	}
-	return true;
+	return ret;
 }
 
-Weight& operator+= (Weight& w1, const Weight& w2)
+template <size_t D>
+Weight<D>& operator+= (Weight<D>& w1, const Weight<D>& w2)
 {
-	for (size_t i = 0; i < WEIGHTS_SIZE; ++i)
+	for (size_t i = 0; i < D; ++i)
 		w1[i] += w2[i];
 	
 	return w1;
 }
 
-Weight operator+ (const Weight& w1, const Weight& w2)
+template <size_t D>
+Weight<D> operator+ (const Weight<D>& w1, const Weight<D>& w2)
 {
-	Weight w (w1);
+	Weight<D> w (w1);
 	w += w2;
 	return w;
 }
 
-Weight& operator-= (Weight& w1, const Weight& w2)
+template <size_t D>
+Weight<D>& operator-= (Weight<D>& w1, const Weight<D>& w2)
 {
-	for (size_t i = 0; i < WEIGHTS_SIZE; ++i)
+	for (size_t i = 0; i < D; ++i)
 		w1[i] -= w2[i];
 	
 	return w1;
 }
 
-Weight operator- (const Weight& w1, const Weight& w2)
+template <size_t D>
+Weight<D> operator- (const Weight<D>& w1, const Weight<D>& w2)
 {
-	Weight w (w1);
+	Weight<D> w (w1);
 	w -= w2;
 	return w;
 }
 
-Weights& operator+= (Weights& weights, const Weights& toAdd)
-{
-	if (weights.empty())
-		weights = toAdd;
-	else
-	{
-		Weights newWeights;
-		newWeights.reserve(weights.size() * toAdd.size());
-		std::swap(weights,newWeights);
-
-		for (const Weight& w1: toAdd)
-		{
-			for (const Weight& w2: newWeights)
-				weights.emplace_back(w1 + w2);
-		}
-	}
-	return weights;
-}
-
-std::ostream& operator<< (std::ostream& stream, const Weight& w)
+std::ostream& printWeight (std::ostream& stream, const float* w, const size_t count)
 {
 	stream << "{" << w[0];
 
-	for (size_t i = 1; i < WEIGHTS_SIZE; ++i)
+	for (size_t i = 1; i < count; ++i)
 		stream << ", " << w[i];
 	
 	stream << "}";
 	return stream;
 }
 
+template <size_t D>
+std::ostream& operator<< (std::ostream& stream, const Weight<D>& w)
+{
+	return printWeight(stream, w.data(), D);
+}
+
 #endif
\ No newline at end of file
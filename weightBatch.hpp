@@ -0,0 +1,429 @@
+#ifndef WEIGHT_BATCH_HPP
+#define WEIGHT_BATCH_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define WEIGHT_BATCH_SSE
+#endif
+
+#include "weight.hpp"
+#include "searchStats.hpp"
+
+//Nombre de poids comparés à la fois: un registre AVX ou deux registres SSE de floats
+constexpr size_t WEIGHT_BATCH_LANES = 8;
+
+//Bit j d'un masque: entrée j d'un bloc de WEIGHT_BATCH_LANES poids
+using WeightMask = uint32_t;
+
+//Ensemble de poids rangés par objectif (une colonne de floats par objectif) pour comparer un poids à
+//WEIGHT_BATCH_LANES poids en une seule fois. Les comparaisons utilisent AVX si le compilateur y a droit (par
+//exemple make CPPFLAGS=-mavx2), SSE sinon. Les colonnes sont dans un seul tableau et ont un nombre entier de blocs
+//pour que les blocs puissent toujours être lus en entier, les entrées après size() n'ont pas de valeur définie
+template <size_t D>
+class WeightBatch
+{
+public:
+	WeightBatch(void): m_size(0), m_capacity(0) {}
+
+	explicit WeightBatch(const Weight<D>& w): WeightBatch() { push_back(w); }
+
+	explicit WeightBatch(const Weights<D>& weights): WeightBatch()
+	{
+		reserve(weights.size());
+		m_size = weights.size();
+
+		for (size_t i = 0; i < weights.size(); ++i)
+		{
+			for (size_t d = 0; d < D; ++d)
+				column(d)[i] = weights[i][d];
+		}
+	}
+
+public:
+	size_t size(void) const { return m_size; }
+	bool empty(void) const { return m_size == 0; }
+
+	const float* column(const size_t d) const { return m_data.data() + d * m_capacity; }
+
+	Weight<D> operator[](const size_t i) const
+	{
+		Weight<D> ret;
+		for (size_t d = 0; d < D; ++d)
+			ret[d] = column(d)[i];
+		return ret;
+	}
+
+	void clear(void) { m_size = 0; }
+
+	void push_back(const Weight<D>& w)
+	{
+		reserve(m_size + 1);
+
+		for (size_t d = 0; d < D; ++d)
+			column(d)[m_size] = w[d];
+
+		++m_size;
+	}
+
+	size_t blockCount(void) const { return blockCountFor(m_size); }
+
+	//Masque des entrées valides du bloc (seul le dernier bloc peut être incomplet)
+	WeightMask validMask(const size_t block) const { return lanesBefore(m_size - block * WEIGHT_BATCH_LANES); }
+
+	//Entrées e du bloc telles que w <= e
+	WeightMask dominatingMask(const size_t block, const Weight<D>& w) const
+	{
+		return compare<Comparison::Dominating>(block, w) & validMask(block);
+	}
+
+	//Entrées e du bloc telles que e <= w
+	WeightMask dominatedMask(const size_t block, const Weight<D>& w) const
+	{
+		return compare<Comparison::Dominated>(block, w) & validMask(block);
+	}
+
+	//Entrées e du bloc telles que w > e
+	WeightMask strictlyDominatedMask(const size_t block, const Weight<D>& w) const
+	{
+		return compare<Comparison::StrictlyDominated>(block, w) & validMask(block);
+	}
+
+	//Vrai si une des entrées d'indice < end est supérieure ou égale à w
+	bool anyDominating(const Weight<D>& w, const size_t end) const
+	{
+		const size_t blocks = blockCountFor(end);
+
+		for (size_t b = 0; b < blocks; ++b)
+		{
+			WeightMask mask = dominatingMask(b, w);
+
+			if (b == blocks - 1)
+				mask &= lanesBefore(end - b * WEIGHT_BATCH_LANES);
+
+			if (mask != 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	bool anyDominating(const Weight<D>& w) const { return anyDominating(w, m_size); }
+
+	//Vrai si toutes les entrées sont inférieures ou égales à w
+	bool allDominated(const Weight<D>& w) const
+	{
+		for (size_t b = 0; b < blockCount(); ++b)
+		{
+			if (dominatedMask(b, w) != validMask(b))
+				return false;
+		}
+
+		return true;
+	}
+
+	//Vrai si e + shift <= t pour toutes les entrées e, sans calculer les sommes dans un autre ensemble. Les sommes sont
+	//arrondies comme celles de operator+=
+	bool allSumsDominated(const Weight<D>& shift, const Weight<D>& t) const
+	{
+		for (size_t b = 0; b < blockCount(); ++b)
+		{
+			if ((sumCompare(b, shift, t) & validMask(b)) != validMask(b))
+				return false;
+		}
+
+		return true;
+	}
+
+	//Ajoute w à toutes les entrées. Ajouter le même poids à tous les poids ne crée pas de poids dominé
+	WeightBatch& operator+=(const Weight<D>& w)
+	{
+		for (size_t d = 0; d < D; ++d)
+		{
+			float* c = column(d);
+
+			for (size_t first = 0; first < blockCount() * WEIGHT_BATCH_LANES; first += WEIGHT_BATCH_LANES)
+			{
+#if defined(__AVX__)
+				_mm256_storeu_ps(c + first, _mm256_add_ps(_mm256_loadu_ps(c + first), _mm256_set1_ps(w[d])));
+#elif defined(WEIGHT_BATCH_SSE)
+				_mm_storeu_ps(c + first, _mm_add_ps(_mm_loadu_ps(c + first), _mm_set1_ps(w[d])));
+				_mm_storeu_ps(c + first + 4, _mm_add_ps(_mm_loadu_ps(c + first + 4), _mm_set1_ps(w[d])));
+#else
+				for (size_t j = 0; j < WEIGHT_BATCH_LANES; ++j)
+					c[first + j] += w[d];
+#endif
+			}
+		}
+
+		return *this;
+	}
+
+	//Ajoute w si aucune entrée ne lui est supérieure ou égale, et supprime alors les entrées qu'il domine. Renvoie
+	//false si w n'a pas été ajouté. Dans un ensemble sans poids dominé, une entrée dominée par w ne peut pas aussi
+	//dominer w: les entrées gardées restent dans le même ordre
+	bool tryInsertAndRemoveDominated(const Weight<D>& w)
+	{
+		if (anyDominating(w))
+			return false;
+
+		size_t kept = 0;
+		for (size_t b = 0; b < blockCount(); ++b)
+		{
+			const WeightMask keep = validMask(b) & ~strictlyDominatedMask(b, w);
+
+			for (size_t j = 0; j < WEIGHT_BATCH_LANES; ++j)
+			{
+				const size_t i = b * WEIGHT_BATCH_LANES + j;
+
+				if ((keep & (WeightMask(1) << j)) == 0)
+					continue;
+
+				if (i != kept)
+				{
+					for (size_t d = 0; d < D; ++d)
+						column(d)[kept] = column(d)[i];
+				}
+
+				++kept;
+			}
+		}
+
+		m_size = kept;
+		push_back(w);
+		return true;
+	}
+
+private:
+	enum class Comparison { Dominating, Dominated, StrictlyDominated };
+
+	static size_t blockCountFor(const size_t n) { return (n + WEIGHT_BATCH_LANES - 1) / WEIGHT_BATCH_LANES; }
+	static WeightMask lanesBefore(const size_t n) { return (n >= WEIGHT_BATCH_LANES) ? WeightMask((1u << WEIGHT_BATCH_LANES) - 1) : WeightMask((1u << n) - 1); }
+
+	float* column(const size_t d) { return m_data.data() + d * m_capacity; }
+
+	//Les colonnes sont déplacées quand leur taille change
+	void reserve(const size_t n)
+	{
+		const size_t capacity = blockCountFor(n) * WEIGHT_BATCH_LANES;
+
+		if (capacity <= m_capacity)
+			return;
+
+		const size_t grown = std::max(capacity, 2 * m_capacity);
+		std::vector<float> data (D * grown);
+
+		for (size_t d = 0; d < D; ++d)
+			std::copy(column(d), column(d) + m_size, data.data() + d * grown);
+
+		std::swap(m_data, data);
+		m_capacity = grown;
+	}
+
+	//Entrées e du bloc pour lesquelles la comparaison C entre w et e est vraie, sans masque des entrées valides
+	template <Comparison C>
+	WeightMask compare(const size_t block, const Weight<D>& w) const
+	{
+		const size_t first = block * WEIGHT_BATCH_LANES;
+
+#if defined(__AVX__)
+		__m256 ok = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		for (size_t d = 0; d < D; ++d)
+		{
+			const __m256 e = _mm256_loadu_ps(column(d) + first);
+			const __m256 x = _mm256_set1_ps(w[d]);
+
+			if (C == Comparison::Dominating)
+				ok = _mm256_and_ps(ok, _mm256_cmp_ps(x, e, _CMP_LE_OQ));
+			else if (C == Comparison::Dominated)
+				ok = _mm256_and_ps(ok, _mm256_cmp_ps(e, x, _CMP_LE_OQ));
+			else
+				ok = _mm256_and_ps(ok, _mm256_cmp_ps(e, x, _CMP_LT_OQ));
+		}
+
+		return WeightMask(_mm256_movemask_ps(ok));
+#elif defined(WEIGHT_BATCH_SSE)
+		__m128 okLow = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 okHigh = okLow;
+
+		for (size_t d = 0; d < D; ++d)
+		{
+			const __m128 eLow = _mm_loadu_ps(column(d) + first);
+			const __m128 eHigh = _mm_loadu_ps(column(d) + first + 4);
+			const __m128 x = _mm_set1_ps(w[d]);
+
+			if (C == Comparison::Dominating)
+			{
+				okLow = _mm_and_ps(okLow, _mm_cmple_ps(x, eLow));
+				okHigh = _mm_and_ps(okHigh, _mm_cmple_ps(x, eHigh));
+			}
+			else if (C == Comparison::Dominated)
+			{
+				okLow = _mm_and_ps(okLow, _mm_cmple_ps(eLow, x));
+				okHigh = _mm_and_ps(okHigh, _mm_cmple_ps(eHigh, x));
+			}
+			else
+			{
+				okLow = _mm_and_ps(okLow, _mm_cmplt_ps(eLow, x));
+				okHigh = _mm_and_ps(okHigh, _mm_cmplt_ps(eHigh, x));
+			}
+		}
+
+		return WeightMask(_mm_movemask_ps(okLow)) | (WeightMask(_mm_movemask_ps(okHigh)) << 4);
+#else
+		WeightMask ret = 0;
+
+		for (size_t j = 0; j < WEIGHT_BATCH_LANES; ++j)
+		{
+			bool ok = true;
+
+			for (size_t d = 0; d < D; ++d)
+			{
+				const float e = column(d)[first + j];
+
+				if (C == Comparison::Dominating)
+					ok &= (w[d] <= e);
+				else if (C == Comparison::Dominated)
+					ok &= (e <= w[d]);
+				else
+					ok &= (e < w[d]);
+			}
+
+			ret |= WeightMask(ok) << j;
+		}
+
+		return ret;
+#endif
+	}
+
+	//Entrées e du bloc telles que e + shift <= t, sans masque des entrées valides
+	WeightMask sumCompare(const size_t block, const Weight<D>& shift, const Weight<D>& t) const
+	{
+		const size_t first = block * WEIGHT_BATCH_LANES;
+
+#if defined(__AVX__)
+		__m256 ok = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		for (size_t d = 0; d < D; ++d)
+		{
+			const __m256 sum = _mm256_add_ps(_mm256_loadu_ps(column(d) + first), _mm256_set1_ps(shift[d]));
+			ok = _mm256_and_ps(ok, _mm256_cmp_ps(sum, _mm256_set1_ps(t[d]), _CMP_LE_OQ));
+		}
+
+		return WeightMask(_mm256_movemask_ps(ok));
+#elif defined(WEIGHT_BATCH_SSE)
+		__m128 okLow = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 okHigh = okLow;
+
+		for (size_t d = 0; d < D; ++d)
+		{
+			const __m128 s = _mm_set1_ps(shift[d]);
+			const __m128 x = _mm_set1_ps(t[d]);
+			okLow = _mm_and_ps(okLow, _mm_cmple_ps(_mm_add_ps(_mm_loadu_ps(column(d) + first), s), x));
+			okHigh = _mm_and_ps(okHigh, _mm_cmple_ps(_mm_add_ps(_mm_loadu_ps(column(d) + first + 4), s), x));
+		}
+
+		return WeightMask(_mm_movemask_ps(okLow)) | (WeightMask(_mm_movemask_ps(okHigh)) << 4);
+#else
+		WeightMask ret = 0;
+
+		for (size_t j = 0; j < WEIGHT_BATCH_LANES; ++j)
+		{
+			bool ok = true;
+
+			for (size_t d = 0; d < D; ++d)
+			{
+				const float sum = column(d)[first + j] + shift[d];
+				ok &= (sum <= t[d]);
+			}
+
+			ret |= WeightMask(ok) << j;
+		}
+
+		return ret;
+#endif
+	}
+
+private:
+	std::vector<float> m_data;//Colonne d: m_data[d * m_capacity] à m_data[d * m_capacity + m_size - 1]
+	size_t m_size;
+	size_t m_capacity;
+};
+
+//w est inférieur ou égal à un des poids
+template <size_t D>
+bool operator<= (const Weight<D>& w, const WeightBatch<D>& weights)
+{
+	return weights.anyDominating(w);
+}
+
+//Tous les poids sont inférieurs ou égaux à W
+template <size_t D>
+bool operator<= (const WeightBatch<D>& weights, const Weight<D>& W)
+{
+	return weights.allDominated(W);
+}
+
+//Au delà de cette taille, une somme de poids max est approchée par une somme plus grosse (voir boundMaxWeights)
+constexpr size_t MAX_WEIGHTS_SUM_MAX_SIZE = 64;
+
+//Remplace des poids par leur maximum composante par composante jusqu'à ce qu'il en reste au plus maxSize. Chaque
+//poids enlevé est inférieur ou égal à un poids gardé: tester que tous les poids sont <= t reste une condition suffisante
+template <size_t D>
+static void boundMaxWeights(WeightBatch<D>& weights, const size_t maxSize)
+{
+	while (weights.size() > maxSize)
+	{
+		Weights<D> sorted;
+		for (size_t i = 0; i < weights.size(); ++i)
+			sorted.emplace_back(weights[i]);
+		std::sort(sorted.begin(), sorted.end(), [](const Weight<D>& a, const Weight<D>& b) { return a[0] > b[0]; });
+
+		WeightBatch<D> merged;
+		for (size_t i = 0; i < sorted.size(); i += 2)
+		{
+			Weight<D> w = sorted[i];
+
+			if (i + 1 < sorted.size())
+			{
+				for (size_t d = 0; d < D; ++d)
+					w[d] = std::max(w[d], sorted[i + 1][d]);
+			}
+
+			merged.tryInsertAndRemoveDominated(w);
+		}
+
+		std::swap(weights, merged);
+	}
+}
+
+//Somme de Minkowski de deux ensembles de poids max dont on ne garde que les poids non dominés: une somme inférieure
+//ou égale à une autre ne change pas le résultat d'un test "toutes les sommes sont <= t". La somme est écrite dans ret,
+//sums est un tableau de travail: l'appelant les garde d'un appel à l'autre pour ne pas réallouer leur mémoire
+template <size_t D>
+static void maxWeightsSum(const WeightBatch<D>& weights1, const WeightBatch<D>& weights2, WeightBatch<D>& ret, WeightBatch<D>& sums)
+{
+	ret.clear();
+
+	for (size_t i = 0; i < weights1.size(); ++i)
+	{
+		//weights2 décalé de weights1[i]: toutes les sommes avec weights1[i] en une seule addition par bloc
+		sums = weights2;
+		sums += weights1[i];
+
+		for (size_t j = 0; j < sums.size(); ++j)
+			ret.tryInsertAndRemoveDominated(sums[j]);
+	}
+
+	WLMC_STATS_MAX(MaxWeightsSumSize, ret.size());
+	boundMaxWeights(ret, MAX_WEIGHTS_SUM_MAX_SIZE);
+}
+
+#endif
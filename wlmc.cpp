@@ -1,340 +1,993 @@
 #include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <chrono>
+#include <string>
+#include <cstdio>
 #include <fstream>
+#include <sstream>
+#include <functional>
+#include <unordered_map>
 #include <signal.h>
 
 #include "graph.hpp"
+#include "weightBatch.hpp"
+#include "threadPool.hpp"
+#include "searchStats.hpp"
+#include "searchCheckpoint.hpp"
+#include "batchList.hpp"
 #include "graphFileReader.hpp"
 
+//La matrice d'adjacence n'est utilisée que pour les graphes assez denses: en dessous, les listes de voisins
+//sont plus courtes que les lignes de la matrice
+constexpr float DENSE_BACKEND_MIN_DENSITY = 0.05f;
+//Et seulement si elle tient en mémoire
+constexpr size_t DENSE_BACKEND_MAX_BYTES = 256 * 1024 * 1024;
+//initialize teste les conditions d'arrêt une fois par paquet de sommets traités
+constexpr size_t INITIALIZE_LIMITS_INTERVAL = 1024;
+
+//Numéro du signal reçu (SIGINT, SIGTERM...), 0 tant qu'aucun n'a été reçu. Écrit par signalHandler
+static std::atomic<int> receivedSignal (0);
+
+//Conditions d'arrêt de la recherche avant la fin: un signal, une durée ou un nombre de noeuds. Elles sont testées par
+//la recherche elle même à chaque noeud, à chaque sommet du premier niveau et pendant initialize. Une fois arrêtée, la recherche remonte
+//sans explorer d'autre branche: les cliques déjà trouvées sont gardées, mais le front n'est plus forcément complet
+class SearchLimits
+{
+public:
+	enum class Reason { None, Signal, TimeLimit, NodeLimit };
+
+public:
+	//timeLimit: en millisecondes depuis la construction, 0 pour aucune limite. nodeLimit: 0 pour aucune limite
+	SearchLimits(const long long timeLimit = 0, const unsigned long long nodeLimit = 0):
+		m_hasDeadline(timeLimit > 0), m_deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimit)), m_nodeLimit(nodeLimit) {}
+
+public:
+	//Appelé à chaque noeud de la recherche: vrai si elle doit s'arrêter
+	bool enterNode(void)
+	{
+		const unsigned long long nodes = m_nodes.fetch_add(1, std::memory_order_relaxed) + 1;
+
+		if ((m_nodeLimit != 0) && (nodes > m_nodeLimit))
+			stop(Reason::NodeLimit);
+
+		return shouldStop();
+	}
+
+	//Vrai si la recherche doit s'arrêter, sans compter de noeud
+	bool shouldStop(void)
+	{
+		if (stopped())
+			return true;
+
+		if (receivedSignal.load(std::memory_order_relaxed) != 0)
+			stop(Reason::Signal);
+		else if (m_hasDeadline && (std::chrono::steady_clock::now() >= m_deadline))
+			stop(Reason::TimeLimit);
+
+		return stopped();
+	}
+
+	bool stopped(void) const { return m_reason.load(std::memory_order_relaxed) != Reason::None; }
+	Reason reason(void) const { return m_reason.load(); }
+	unsigned long long nodes(void) const { return m_nodes.load(); }
+
+private:
+	//Seule la première raison est gardée
+	void stop(const Reason reason)
+	{
+		Reason none = Reason::None;
+		m_reason.compare_exchange_strong(none, reason);
+	}
+
+private:
+	bool m_hasDeadline;
+	std::chrono::steady_clock::time_point m_deadline;
+	unsigned long long m_nodeLimit;
+	std::atomic<unsigned long long> m_nodes {0};
+	std::atomic<Reason> m_reason {Reason::None};
+};
+
+template <size_t D>
 struct InitReturnType
 {
 	Clique C0;			//Initial clique
 	VertexOrdering O0;	//Initial ordering
-	Graph Gp;			//Reduced graph G'
+	SubgraphView<D> Gp;	//Reduced graph G'
 };
 
-/** TESTEE ET FONCTIONNE CORRECTEMENT **/
-InitReturnType initialize(const Graph& G, Weight lb)
+//Ordre de dégénérescence en O(V+E) avec une file à seaux: les sommets restants sont rangés par degré dans un seul
+//tableau (un seau par degré), retirer le sommet de degré min et décrémenter le degré de ses voisins se fait en temps
+//constant. Dès que les sommets restants forment une clique, ils deviennent la clique initiale C0.
+//Les sommets dont le poids avec celui de leurs voisins est dominé par lb sont ensuite retirés du graphe en une seule
+//passe (les poids des voisins des sommets retirés sont mis à jour au fur et à mesure), puis Gp est construit une fois.
+//Si limits arrête la recherche pendant la construction des listes de voisins, G est renvoyé tel quel, dans l'ordre de
+//ses sommets et sans clique initiale. S'il l'arrête pendant le retrait des sommets, Gp peut encore contenir des sommets
+//qui auraient été retirés
+template <size_t D>
+InitReturnType<D> initialize(const SubgraphView<D>& G, Weight<D> lb, SearchLimits* limits = nullptr)
 {
-	VertexOrdering O0;	O0.reserve(G.size());
+	WLMC_STATS_TIME(Initialize);
+	const Vertices& U = G.getVertices();
+	const size_t n = U.size();
+	VertexIdVector O0;	O0.reserve(n);
 	Clique C0;
-	Graph Gp(G);//Gp = G' (G prime)
-	//Calcule le degré de chaque sommets. Contient aussi U qui est l'ensemble des sommets
-	VertexDegreePairs degrees(G.computeDegrees());
-	std::sort(degrees.begin(),degrees.end(),
-		[](const VertexDegreePair& a, const VertexDegreePair& b) { return a.d > b.d; });
 
-	for (size_t i = 0; i < G.size(); ++i)
+	//Voisins de chaque sommet sous forme d'indices dans U (U est trié)
+	std::vector<size_t> adjBegin (n + 1, 0);
+	std::vector<uint32_t> adj;
+	auto shouldStop = [limits](const size_t step) { return (limits != nullptr) && (step % INITIALIZE_LIMITS_INTERVAL == 0) && limits->shouldStop(); };
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (shouldStop(i))
+			return { C0, VertexOrdering(VertexIdVector(U.begin(), U.end())), G };
+
+		for (const VertexId neighbor: G.neighbors(U[i]))
+			adj.emplace_back((uint32_t)(std::lower_bound(U.begin(), U.end(), neighbor) - U.begin()));
+		adjBegin[i + 1] = adj.size();
+	}
+
+	//Tri des sommets par degré: les sommets de degré d sont dans order[binBegin[d]...]
+	std::vector<unsigned int> degree (n);
+	unsigned int maxDegree = 0;
+	for (size_t i = 0; i < n; ++i)
 	{
-		const VertexDegreePair& vi = degrees.back();
+		degree[i] = (unsigned int)(adjBegin[i + 1] - adjBegin[i]);
+		maxDegree = std::max(maxDegree, degree[i]);
+	}
 
-		if (vi.d == degrees.size() - 1)
+	std::vector<size_t> binBegin (maxDegree + 2, 0);
+	for (size_t i = 0; i < n; ++i)
+		++binBegin[degree[i] + 1];
+	for (size_t d = 1; d < binBegin.size(); ++d)
+		binBegin[d] += binBegin[d - 1];
+
+	std::vector<uint32_t> order (n);
+	std::vector<size_t> position (n);
+	{
+		std::vector<size_t> next (binBegin.begin(), binBegin.end() - 1);
+		for (size_t i = 0; i < n; ++i)
+		{
+			position[i] = next[degree[i]]++;
+			order[position[i]] = (uint32_t)i;
+		}
+	}
+
+	for (size_t k = 0; k < n; ++k)
+	{
+		const uint32_t vi = order[k];
+
+		//Le sommet de degré min est voisin de tous les autres sommets restants: ils forment une clique
+		if (degree[vi] == n - k - 1)
 		{
 			//Order U arbitrarily as vi, v_(i+1), v_(i+2)...
-			std::sort(degrees.begin(), degrees.end(),
-				[](const VertexDegreePair& a, const VertexDegreePair& b) { return a.v->num() < b.v->num(); });
+			std::sort(order.begin() + k, order.end(),
+				[&G, &U](const uint32_t a, const uint32_t b) { return G.number(U[a]) < G.number(U[b]); });
 
-			for (const auto& vdp : degrees)
+			for (size_t j = k; j < n; ++j)
 			{
 				//On ajoute tous les sommets dans O0
-				O0.emplace_back(vdp.v->vertex);
+				O0.emplace_back(U[order[j]]);
 				//Les sommets restant font partis de la clique initial C0
-				C0.emplace_back(vdp.v->vertex);
+				C0.emplace_back(U[order[j]]);
 			}
 			break;
 		}
 
-		//U <- U\{vi} fait plus tard car on a besoin de vi ensuite
+		//O0 est l'ensemble des sommets dans l'ordre avec lequel ils sont trouvés par cette fonction
+		O0.emplace_back(U[vi]);
 
-		//For each neighbors v of vi: deg(v) -= 1
-		const std::vector<VertexStructPtr>& neighbors = vi.v->neighbors;
+		//For each neighbors v of vi: deg(v) -= 1. Le voisin passe en tête de son seau, puis le début du seau avance
+		//d'une case: il se retrouve à la fin du seau d'en dessous. Les seaux qui commencent avant k + 1 commencent en
+		//fait à k + 1, les sommets placés avant sont déjà retirés. Les degrés restent exacts (pas seulement les
+		//numéros de coeur) pour savoir quand les sommets restants forment une clique
+		for (size_t e = adjBegin[vi]; e < adjBegin[vi + 1]; ++e)
+		{
+			const uint32_t v = adj[e];
 
-		for (const Vertex& neighbor: neighbors)
+			if (position[v] > k)
+			{
+				const size_t first = std::max(binBegin[degree[v]], k + 1);
+				const uint32_t w = order[first];
+
+				std::swap(order[first], order[position[v]]);
+				std::swap(position[v], position[w]);
+				binBegin[degree[v]] = first + 1;
+				--degree[v];
+			}
+		}
+	}
+
+	if (G.weight(C0) > lb)
+		lb = G.weight(C0);
+
+	//w_s: poids du sommet plus celui de ses voisins encore présents. Un sommet retiré fait baisser w_s de ses voisins
+	std::vector<Weight<D>> w_s (n);
+	std::vector<bool> removed (n, false);
+	std::vector<uint32_t> toRemove;
+
+	auto neighborhoodWeight = [&G, &U, &adj, &adjBegin, &removed](const uint32_t i)
 		{
-			for (size_t i = 0; i < degrees.size(); ++i)
+			Weight<D> ret = G.weight(U[i]);
+			for (size_t e = adjBegin[i]; e < adjBegin[i + 1]; ++e)
 			{
-				if (degrees[i].v->vertex == neighbor.vertex)
-				{
-					--degrees[i].d;
+				if (!removed[adj[e]])
+					ret += G.weight(U[adj[e]]);
+			}
+			return ret;
+		};
 
-					for (size_t j = i; (j < degrees.size()-2) && (degrees[j+1].d > degrees[j].d); ++j)
-						std::swap(degrees[j+1],degrees[j]);
-					
-					break;
+	for (size_t i = 0; i < n; ++i)
+	{
+		w_s[i] = neighborhoodWeight((uint32_t)i);
+
+		if (w_s[i] <= lb)
+			toRemove.emplace_back((uint32_t)i);
+	}
+
+	for (const uint32_t i: toRemove)
+		removed[i] = true;
+
+	for (size_t step = 1; !toRemove.empty() && !shouldStop(step); ++step)
+	{
+		const uint32_t u = toRemove.back();
+		toRemove.pop_back();
+
+		for (size_t e = adjBegin[u]; e < adjBegin[u + 1]; ++e)
+		{
+			const uint32_t v = adj[e];
+
+			if (!removed[v])
+			{
+				w_s[v] -= G.weight(U[u]);
+
+				//Les soustractions peuvent arrondir: le poids est recalculé avant de retirer le sommet
+				if ((w_s[v] <= lb) && ((w_s[v] = neighborhoodWeight(v)) <= lb))
+				{
+					removed[v] = true;
+					toRemove.emplace_back(v);
 				}
 			}
 		}
+	}
 
-		//O0 est l'ensemble des sommets dans l'ordre avec lequel ils sont trouvés par cette fonction
-		O0.emplace_back(vi.v->vertex);
-		//U <- U\{vi} Cette ligne arrive à la fin car on a besoin de vi avant
-		degrees.pop_back();
+	Vertices kept;
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (!removed[i])
+			kept.emplace_back(U[i]);
 	}
 
-	if (C0.weight() > lb)
-		lb = C0.weight();
+	return { C0, VertexOrdering(O0), SubgraphView<D>(G.graph(), kept, true) };
+}
+
+//Borne utilisée par getBranches: la somme de Minkowski des poids max des ensembles indépendants de PI. Seuls ses
+//poids non dominés sont gardés, et elle est mise à jour à chaque fois qu'un sommet entre dans PI au lieu d'être
+//recalculée pour chaque sommet. Toutes les sommes sont <= t.
+//Pour ajouter un sommet à l'ensemble j, il faut la somme des autres ensembles: c'est la somme des ensembles avant j
+//(préfixe) plus celle des ensembles après j (suffixe). Les préfixes et suffixes sont gardés d'un sommet à l'autre, et
+//seuls ceux qui contiennent un ensemble modifié sont recalculés, quand ils servent à nouveau. Les ensembles de poids
+//sont des WeightBatch: les tests contre t et les décalages sont faits bloc par bloc. reset vide la borne sans libérer
+//ses ensembles, qui servent au getBranches suivant du même thread (voir BranchScratch)
+template <size_t D>
+class IndependentSetsBound
+{
+public:
+	//Plus aucun ensemble dans PI, la somme est le poids nul
+	void reset(const Weight<D>& t)
+	{
+		m_t = t;
+		m_setCount = 0;
+		resetToZero(m_sum);
+		resetToZero(slot(m_prefix, 0));
+		resetToZero(slot(m_suffix, 0));
+		m_validPrefixes = 1;
+		m_firstValidSuffix = 0;
+	}
 
-	for (const Vertex& v : G.getVertices())
+	//Ajoute l'ensemble {v} si toutes les sommes restent <= t
+	bool tryCreateSet(const Weight<D>& w)
 	{
-		Weight w_s = Vertices(v.neighbors).weight() + v.weight();
+		if (!m_sum.allSumsDominated(w, m_t))
+			return false;
+
+		WeightBatch<D>& maxWeights = slot(m_maxWeights, m_setCount);
+		maxWeights.clear();
+		maxWeights.push_back(w);
+		m_sum += w;
 
-		if (w_s <= lb)
-			Gp.removeVertex(v);
+		//Le nouvel ensemble est le dernier: les préfixes existants ne changent pas, tous les suffixes valides sont
+		//décalés de w
+		slot(m_prefix, m_setCount + 1);
+		for (size_t k = m_firstValidSuffix; k <= m_setCount; ++k)
+			m_suffix[k] += w;
+		resetToZero(slot(m_suffix, m_setCount + 1));
+		++m_setCount;
+
+		return true;
 	}
-	return { C0, O0, Gp };
-}
 
-Vertices getBranches(const Graph& G, const Weight t, const VertexOrdering& O)
+	//Ajoute v à l'ensemble j si toutes les sommes restent <= t
+	bool tryJoinSet(const size_t j, const Weight<D>& w)
+	{
+		//Les poids max de l'ensemble ne changent pas
+		if (w <= m_maxWeights[j])
+			return true;
+
+		//Sinon les nouvelles sommes sont celles qui passent par w: w plus la somme des autres ensembles
+		maxWeightsSum(prefix(j), suffix(j + 1), m_withW, m_sums);
+
+		if (!m_withW.allSumsDominated(w, m_t))
+			return false;
+
+		m_withW += w;
+		m_maxWeights[j].tryInsertAndRemoveDominated(w);
+		for (size_t i = 0; i < m_withW.size(); ++i)
+			m_sum.tryInsertAndRemoveDominated(m_withW[i]);
+		WLMC_STATS_MAX(MaxWeightsSumSize, m_sum.size());
+		boundMaxWeights(m_sum, MAX_WEIGHTS_SUM_MAX_SIZE);
+
+		//Les préfixes après j et les suffixes jusqu'à j contiennent l'ensemble j
+		m_validPrefixes = std::min(m_validPrefixes, j + 1);
+		m_firstValidSuffix = std::max(m_firstValidSuffix, j + 1);
+
+		return true;
+	}
+
+private:
+	//Somme des ensembles d'indice < j
+	const WeightBatch<D>& prefix(const size_t j)
+	{
+		for (; m_validPrefixes <= j; ++m_validPrefixes)
+			maxWeightsSum(m_prefix[m_validPrefixes - 1], m_maxWeights[m_validPrefixes - 1], m_prefix[m_validPrefixes], m_sums);
+
+		return m_prefix[j];
+	}
+
+	//Somme des ensembles d'indice >= j
+	const WeightBatch<D>& suffix(const size_t j)
+	{
+		for (; m_firstValidSuffix > j; --m_firstValidSuffix)
+			maxWeightsSum(m_maxWeights[m_firstValidSuffix - 1], m_suffix[m_firstValidSuffix], m_suffix[m_firstValidSuffix - 1], m_sums);
+
+		return m_suffix[j];
+	}
+
+	//Case k de sets, ajoutée si besoin. Les cases au delà de celles utilisées gardent les ensembles d'un appel précédent
+	static WeightBatch<D>& slot(std::vector<WeightBatch<D>>& sets, const size_t k)
+	{
+		if (sets.size() <= k)
+			sets.resize(k + 1);
+		return sets[k];
+	}
+
+	static void resetToZero(WeightBatch<D>& weights)
+	{
+		weights.clear();
+		weights.push_back(Weight<D>());
+	}
+
+private:
+	Weight<D> m_t;
+	size_t m_setCount = 0;
+	std::vector<WeightBatch<D>> m_maxWeights;//Poids max de chaque ensemble de PI, les m_setCount premiers sont utilisés
+	WeightBatch<D> m_sum;
+	std::vector<WeightBatch<D>> m_prefix;//m_prefix[j]: somme des ensembles d'indice < j, valide si j < m_validPrefixes
+	std::vector<WeightBatch<D>> m_suffix;//m_suffix[j]: somme des ensembles d'indice >= j, valide si j >= m_firstValidSuffix
+	size_t m_validPrefixes = 1;
+	size_t m_firstValidSuffix = 0;
+	WeightBatch<D> m_withW;//Tableaux de travail de tryJoinSet et maxWeightsSum
+	WeightBatch<D> m_sums;
+};
+
+//Tableaux de travail de getBranches. Chaque thread a les siens: ils gardent leur mémoire d'un appel à l'autre, et d'un
+//graphe à l'autre quand un thread en résout plusieurs (--batch)
+template <size_t D>
+struct BranchScratch
+{
+	Vertices V;
+	std::vector<std::pair<uint32_t, VertexId>> ranked;//Pour VertexOrdering::sort
+	VerticesSet PI;//Seuls les setCount premiers ensembles sont utilisés
+	size_t setCount = 0;
+	IndependentSetsBound<D> bound;
+};
+
+template <size_t D>
+Vertices getBranches(const SubgraphView<D>& G, const Weight<D> t, const VertexOrdering& O)
 {
+	WLMC_STATS_TIME(GetBranches);
+	//getBranches ne lance pas de tâche: un thread ne l'exécute jamais deux fois à la fois
+	static thread_local BranchScratch<D> scratch;
+	VerticesSet& PI = scratch.PI;
+	size_t& setCount = scratch.setCount;
+	IndependentSetsBound<D>& bound = scratch.bound;
+	Vertices& V = scratch.V;
+
 	Vertices B;
-	VerticesSet PI;
-	Vertices V = G.getVertices();
-	V.orderWith(O);
+	setCount = 0;
+	bound.reset(t);
+	V = G.getVertices();
+	O.sort(V, scratch.ranked);
 
 	for (size_t i = V.size() - 1; i < V.size(); --i)
 	{
-		const Vertex& v = V[i];
+		const VertexId v = V[i];
 
-		Vertices* found = nullptr;
-		bool tryCreateNewIS = true;
+		size_t found = setCount;
 		bool vertexShouldBeAddedToBranche = true;
 
 		//Première partie de la condition: si il existe un ensemble D de PI qui n'a pas de voisin de v dedans
-		for (Vertices& s: PI.set)
+		for (size_t j = 0; j < setCount; ++j)
 		{
 			bool neighborFound = false;
 
-			for (const Vertex& n: v.neighbors)
+			//Avec la matrice d'adjacence le test est une lecture de bit, sinon une recherche dans la ligne triée de v
+			for (const VertexId testVertex: PI.set[j])
 			{
-				for (const Vertex& testVertex: s)
+				if (G.adjacent(v, testVertex))
 				{
-					if (testVertex == n)
-					{
-						neighborFound = true;
-						break;
-					}
-				}
-
-				if (neighborFound)
+					neighborFound = true;
 					break;
+				}
 			}
 
 			if (!neighborFound)
 			{
-				found = &s;
+				found = j;
 				break;
 			}
 		}
 
 		//Si la première partie de la condition est vraie, on passe à la deuxième partie qui vérifie que
 		//la somme des poids max n'est pas supérieures à t une fois que l'on a ajouté v dans l'ensemble que
-		//l'on a trouvé juste avant
-		if (found != nullptr)
+		//l'on a trouvé juste avant. Sinon on essaie de créer un nouvel ensemble indépendant avec ce sommet
+		if ((found < setCount) && bound.tryJoinSet(found, G.weight(v)))
+		{
+			PI.set[found].emplace_back(v);
+			vertexShouldBeAddedToBranche = false;
+		}
+		//S'il existe un des poids max pour lequel on ne peut pas dire qu'il est <= t, alors on ne peut pas créer un nouvel ensemble indépendant,
+		//il faudra ajouter ce sommet à l'ensemble des sommets de branchements
+		else if (bound.tryCreateSet(G.weight(v)))
 		{
-			found->emplace_back(v);
-			Weights sumMaxWeights;
-
-			for (const Vertices& vs : PI.set)
-				sumMaxWeights += vs.getMaxWeights();
-
-			//S'il exite un poids qui domine t, alors la deuxième partie de la conition est fausse,
-			//on passe donc au bloc else if qui va essayer de créer un nouvel ensemble indépendant avec
-			//ce sommet
-			if (!(sumMaxWeights <= t))
-				found->pop_back();
-			else
+			if (PI.set.size() == setCount)
+				PI.set.emplace_back();
+			PI.set[setCount].clear();
+			PI.set[setCount].emplace_back(v);
+			++setCount;
+			vertexShouldBeAddedToBranche = false;
+		}
+
+		if (vertexShouldBeAddedToBranche)
+			B.emplace_back(v);
+	}
+	
+	//V est parcouru à l'envers: B est dans l'ordre inverse de O
+	std::reverse(B.begin(), B.end());
+	return B;
+}
+
+//Front de Pareto partagé par tous les threads de WLMC. Une clique ajoutée par un thread est tout de suite utilisée
+//par les autres pour éliminer des sommets et couper des branches
+template <size_t D>
+class SharedCliques
+{
+public:
+	SharedCliques(const Cliques<D>& cliques): m_cliques(cliques), m_weights(std::make_shared<const WeightBatch<D>>(cliques.weights())) {}
+
+public:
+	//Vrai si une clique du front a un poids supérieur ou égal à w. Ne prend pas le verrou: les poids du front
+	//sont lus depuis la dernière copie publiée par tryInsert
+	bool dominates(const Weight<D>& w) const
+	{
+		WLMC_STATS_TIME(Front);
+		const std::shared_ptr<const WeightBatch<D>> weights = std::atomic_load(&m_weights);
+
+		//Les poids sont triés par premier objectif décroissant, seuls ceux avant end peuvent dominer w
+		const float* first = weights->column(0);
+		const size_t end = std::upper_bound(first, first + weights->size(), w[0], std::greater<float>()) - first;
+		return weights->anyDominating(w, end);
+	}
+
+	//Si le poids potentiel d'une clique est dominé par une clique de l'ensemble de pareto, on renvoie false. Sinon
+	//cliqueToImprove est la première clique que l'on trouve potentiellement améliorable
+	bool findCliqueToImprove(const Weight<D>& potentialWeight, Clique& cliqueToImprove) const
+	{
+		WLMC_STATS_TIME(Front);
+		std::lock_guard<std::mutex> lock (m_mutex);
+		bool cliqueToImproveFound = false;
+		//Seules les cliques placées avant cet indice peuvent dominer le poids potentiel, toutes celles qui sont
+		//après sont améliorables
+		const size_t end = m_cliques.dominatingCandidatesEnd(potentialWeight);
+
+		for (size_t i = 0; i < end; ++i)
+		{
+			//Le poids potentiel est dominé
+			if (m_cliques.weight(i) > potentialWeight)
+				return false;
+
+			//On enregistre la première clique améliorable
+			if (!cliqueToImproveFound && !(potentialWeight <= m_cliques.weight(i)))
 			{
-				//Sinon on arrive à la fin de la boucle, alors on peut ajouter v dans l'ensemble indépendant trouvé
-				//dans found, mais comme cette action a été faite au début du bloc, l'algorithme ce termine ici pour ce sommet
-				tryCreateNewIS = false;
-				vertexShouldBeAddedToBranche = false;
+				cliqueToImprove = m_cliques.value(i);
+				cliqueToImproveFound = true;
 			}
 		}
 
-		if (tryCreateNewIS)
+		if (!cliqueToImproveFound && (end < m_cliques.size()))
 		{
-			Weights sumMaxWeights = { v.weight() };
-			bool shouldCreateNewIS = true;
+			cliqueToImprove = m_cliques.value(end);
+			cliqueToImproveFound = true;
+		}
 
-			for (const Vertices& vs : PI.set)
-				sumMaxWeights += vs.getMaxWeights();
+		return cliqueToImproveFound;
+	}
 
-			//S'il existe un des poids max pour lequel on ne peut pas dire qu'il est <= t, alors on ne peut pas créer un nouvel ensemble indépendant,
-			//il faudra ajouter ce sommet à l'ensemble des sommets de branchements
-			if (!(sumMaxWeights <= t))
-				shouldCreateNewIS = false;
+	//La clique n'est ajoutée que si aucune clique de même poids ou de poids supérieur n'est dans l'ensemble, les
+	//cliques qu'elle domine sont alors supprimées. Elle n'est recopiée que si elle est ajoutée
+	void tryInsert(const PartialClique<D>& clique)
+	{
+		WLMC_STATS_TIME(Front);
+		std::lock_guard<std::mutex> lock (m_mutex);
 
-			if (shouldCreateNewIS)
-			{
-				vertexShouldBeAddedToBranche = false;
-				PI.set.emplace_back(Vertices({ v }));
-			}
+		if (!m_cliques.isDominated(clique.weight()))
+		{
+#if defined(WLMC_STATS)
+			const size_t sizeBefore = m_cliques.size();
+#endif
+			m_cliques.tryInsert(clique.weight(), clique.materialize());
+			WLMC_STATS_COUNT(FrontInserts, 1);
+			WLMC_STATS_COUNT(FrontEvictions, sizeBefore + 1 - m_cliques.size());
+			std::atomic_store(&m_weights, std::make_shared<const WeightBatch<D>>(m_cliques.weights()));
 		}
+	}
 
-		if (vertexShouldBeAddedToBranche)
-			B.emplace_back(v);
+	Cliques<D> get(void) const
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		return m_cliques;
 	}
-	
-	B.orderWith(O);
-	return B;
-}
 
-Cliques searchMaxWCliques(const Graph& G, const Clique& Cmax, const Clique& C, const VertexOrdering& O)
+private:
+	mutable std::mutex m_mutex;
+	Cliques<D> m_cliques;
+	std::shared_ptr<const WeightBatch<D>> m_weights;//Poids de m_cliques
+};
+
+//En dessous de cette taille, les branches d'un sous graphe sont explorées séquentiellement: les tâches coûteraient
+//plus cher que le travail qu'elles répartissent
+constexpr size_t PARALLEL_MIN_SUBGRAPH_SIZE = 32;
+//Au delà de cette taille de clique aussi
+constexpr size_t PARALLEL_MAX_DEPTH = 16;
+
+//Paramètres partagés par tous les appels récursifs de searchMaxWCliques
+template <size_t D>
+struct SearchContext
+{
+	const SharedCliques<D>* front;//Une branche dont le poids potentiel est dominé par le front est coupée
+	ThreadPool* pool;//nullptr: recherche séquentielle
+	SearchLimits* limits;
+};
+
+//Les cliques sont des PartialClique<D>: ajouter B[i] à C ne recopie pas C, et les poids sont calculés au fur et à mesure
+template <size_t D>
+PartialCliques<D> searchMaxWCliques(const SubgraphView<D>& G, const PartialClique<D>& Cmax, const PartialClique<D>& C, const VertexOrdering& O, const SearchContext<D>& context)
 {
+	WLMC_STATS_COUNT(Nodes, 1);
+
+	//Recherche arrêtée: Cmax est une clique, mais ce n'est plus forcément la meilleure de cette branche
+	if (context.limits->enterNode())
+		return PartialCliques<D>(Cmax.weight(), Cmax);
+
 	if (G.empty())
-		return {{ C }};
+		return PartialCliques<D>(C.weight(), C);
 
 	Vertices B = getBranches(G, Cmax.weight() - C.weight(), O);
 	if (B.empty())
-		return {{ Cmax }};
+		return PartialCliques<D>(Cmax.weight(), Cmax);
+
+	WLMC_STATS_COUNT(Branches, B.size());
 
-	Vertices A = G.getVertices();
-	A.remove(B);
-	B.orderWith(O);
+	//A ∪ {B[i+1], B[i+2], ...}: on part de A = V\B puis on ajoute B[i] une fois qu'il a été traité. Avec la matrice
+	//d'adjacence c'est un masque, sinon un ensemble trié par identifiant
+	Bitset candidates;
+	Vertices sortedCandidates;
 
-	Cliques results {{ Cmax }};
+	if (G.isDense())
+	{
+		candidates = G.membership(G.getVertices());
+
+		for (const VertexId b: B)
+			candidates.reset(b);
+	}
+	else
+	{
+		Vertices sortedB (B);
+		std::sort(sortedB.begin(), sortedB.end());
+		differenceSorted(G.getVertices(), sortedB, sortedCandidates);
+	}
+
+	PartialCliques<D> results (Cmax.weight(), Cmax);
+
+	//Les branches des gros sous graphes sont des tâches du groupe de threads. Leurs résultats sont fusionnés dans
+	//l'ordre des branches une fois qu'elles sont toutes terminées
+	const bool parallel = (context.pool != nullptr) && (G.size() >= PARALLEL_MIN_SUBGRAPH_SIZE) && (C.size() < PARALLEL_MAX_DEPTH);
+	std::vector<PartialCliques<D>> branchResults (parallel ? B.size() : 0);
+	std::unique_ptr<TaskGroup> branches (parallel ? new TaskGroup(*context.pool) : nullptr);
 
 	for (size_t i = B.size() - 1; i < B.size(); --i)
 	{
-		const Vertices& BSubset = B.subSet(i + 1, B.size() - 1);
-		const Vertices& unionWithA = Vertices::unionBetween(A, BSubset);
-		const Vertices& neighbors = B[i].neighbors;
-		Vertices P(Vertices::intersectionBetween(neighbors, unionWithA));
+		if (context.limits->stopped())
+			break;
 
-		if (!(Vertices::unionBetween(C, B[i]).weight() + P.weight() <= Cmax.weight()))
+		Vertices P;
+
+		if (G.isDense())
+		{
+			P = G.neighborsIn(B[i], candidates);
+			candidates.set(B[i]);
+		}
+		else
 		{
-			Cliques Cp = searchMaxWCliques(G[P], Cmax, Vertices::unionBetween(C, B[i]), O);
+			//Les candidats sont des sommets de G: inutile de passer par les voisins de B[i] dans G
+			intersectSorted(G.graph().neighbors(B[i]), sortedCandidates, P);
+			sortedCandidates.insertSorted(B[i]);
+		}
+
+		const PartialClique<D> Ci = C.extendedWith(B[i], G.weight(B[i]));
+		const Weight<D> potentialWeight = Ci.weight() + G.weight(P);
 
-			for (const Clique& c: Cp.set)
-				results.tryInsertAndRemoveDominated(c);
+		//La branche est coupée si son poids potentiel est dominé par Cmax ou par une clique déjà trouvée par un thread
+		if (potentialWeight <= Cmax.weight())
+			WLMC_STATS_COUNT(BranchesPrunedByBound, 1);
+		else if (context.front->dominates(potentialWeight))
+			WLMC_STATS_COUNT(BranchesPrunedByFront, 1);
+		else if (parallel)
+		{
+			PartialCliques<D>& branchResult = branchResults[i];
+			branches->run([&G, &Cmax, &O, &context, &branchResult, P, Ci] { branchResult = searchMaxWCliques(G[P], Cmax, Ci, O, context); });
 		}
+		else
+		{
+			results.merge(searchMaxWCliques(G[P], Cmax, Ci, O, context));
+		}
+	}
+
+	if (parallel)
+	{
+		branches->wait();
+
+		for (size_t i = B.size() - 1; i < B.size(); --i)
+			results.merge(branchResults[i]);
 	}
 
 	return results;
 }
 
-Cliques WLMC(const Graph& G, long long& duration)
+//Cherche les cliques de poids max contenant vi dans G[P ∪ {vi}]
+template <size_t D>
+static void improveWithVertex(const Graph<D>& G, const VertexId vi, const Vertices& P, SharedCliques<D>& Cmax, ThreadPool* pool, SearchLimits& limits)
+{
+	Clique cliqueToImprove;
+	WLMC_STATS_COUNT(TopLevelVertices, 1);
+
+	//Si le poid estimé d'une clique est dominé par une clique de l'ensemble de pareto, on passe directement
+	//au sommet suivant
+	if (!Cmax.findCliqueToImprove(G.weight(P) + G.weight(vi), cliqueToImprove))
+	{
+		WLMC_STATS_COUNT(TopLevelSkipped, 1);
+		return;
+	}
+
+	//On entre ici s'il existe une clique à améliorer. Sur un gros sous graphe, initialize peut être longue: la
+	//recherche n'est pas lancée si elle a été arrêtée entre temps
+	if (limits.shouldStop())
+		return;
+
+	InitReturnType<D> ip = initialize(G[P], G.weight(cliqueToImprove) - G.weight(vi), &limits);
+
+	if (limits.stopped())
+		return;
+
+	if (!((G.weight(ip.C0) + G.weight(vi)) <= G.weight(cliqueToImprove)))
+		cliqueToImprove = Vertices::unionBetween(ip.C0, vi);
+
+	PartialClique<D> best;
+	for (const VertexId v: cliqueToImprove)
+		best = best.extendedWith(v, G.weight(v));
+
+	PartialCliques<D> Cp = searchMaxWCliques(ip.Gp, best, PartialClique<D>().extendedWith(vi, G.weight(vi)), ip.O0, { &Cmax, pool, &limits });
+
+	for (size_t k = 0; k < Cp.size(); ++k)
+	{
+		if (!(Cp.weight(k) <= best.weight()))
+			best = Cp.value(k);
+
+		//Maintenant que l'on a remplacé l'ancienne clique par une meilleure, on essaie de l'ajouter à l'ensemble des solutions
+		Cmax.tryInsert(best);
+	}
+}
+
+//Avancement de la boucle du premier niveau de WLMC, qui parcourt Vp de la fin au début: les finished premiers sommets
+//parcourus (sur count) ont été traités jusqu'au bout. Les sommets traités plus loin par d'autres threads ne comptent pas
+struct SearchProgress
+{
+	size_t count = 0;
+	size_t finished = 0;
+};
+
+//Marque les étapes terminées de la boucle du premier niveau, dans n'importe quel ordre, et tient à jour le nombre
+//d'étapes terminées sans trou depuis la première
+class TopLevelProgress
+{
+public:
+	//Les finished premières étapes sont déjà terminées (reprise d'une recherche)
+	TopLevelProgress(const size_t count, const size_t finished = 0): m_done(count, false), m_finished(finished)
+	{
+		std::fill(m_done.begin(), m_done.begin() + finished, true);
+	}
+
+public:
+	void markDone(const size_t step)
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_done[step] = true;
+
+		while ((m_finished < m_done.size()) && m_done[m_finished])
+			++m_finished;
+	}
+
+	size_t finished(void) const
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		return m_finished;
+	}
+
+private:
+	mutable std::mutex m_mutex;
+	std::vector<bool> m_done;
+	size_t m_finished;
+};
+
+//Points de reprise de WLMC (voir searchCheckpoint.hpp)
+struct CheckpointSettings
+{
+	std::string path;//Vide: pas de point de reprise
+	long long interval = 60000;//Durée minimale entre deux enregistrements, en millisecondes
+	bool resume = false;//Reprend la recherche enregistrée dans path, s'il existe
+};
+
+//Empreinte du graphe réduit parcouru par la boucle du premier niveau: les sommets de Vp dans l'ordre, avec leurs
+//numéros, leurs poids et les numéros de leurs voisins
+template <size_t D>
+static uint64_t reducedGraphFingerprint(const Graph<D>& Gr, const Vertices& Vp)
+{
+	Fingerprint ret;
+	ret.add((uint64_t)D);
+	ret.add((uint64_t)Vp.size());
+
+	for (const VertexId v: Vp)
+	{
+		ret.add((uint32_t)Gr.number(v));
+		ret.add(Gr.weight(v));
+
+		for (const VertexId n: Gr.neighbors(v))
+			ret.add((uint32_t)Gr.number(n));
+	}
+
+	return ret.value();
+}
+
+//Enregistre l'avancement de la boucle du premier niveau au plus une fois par intervalle. Un seul thread enregistre à
+//la fois, les autres continuent sans l'attendre. Une erreur d'écriture est signalée mais n'arrête pas la recherche
+template <size_t D>
+class CheckpointWriter
+{
+public:
+	CheckpointWriter(const CheckpointSettings& settings, const Graph<D>& G, const uint64_t fingerprint, const size_t topLevelCount):
+		m_settings(settings), m_graph(G), m_fingerprint(fingerprint), m_topLevelCount(topLevelCount), m_last(std::chrono::steady_clock::now()) {}
+
+public:
+	void tick(const TopLevelProgress& progress, const SharedCliques<D>& front)
+	{
+		std::unique_lock<std::mutex> lock (m_mutex, std::try_to_lock);
+
+		if (lock.owns_lock() && (std::chrono::steady_clock::now() - m_last >= std::chrono::milliseconds(m_settings.interval)))
+			write(progress.finished(), front);
+	}
+
+	//Le front est lu après l'avancement: il contient au moins les cliques trouvées par les étapes terminées
+	void write(const size_t finished, const SharedCliques<D>& front)
+	{
+		SearchCheckpoint checkpoint;
+		checkpoint.fingerprint = m_fingerprint;
+		checkpoint.topLevelCount = m_topLevelCount;
+		checkpoint.topLevelFinished = finished;
+
+		const Cliques<D> cliques = front.get();
+		for (const Clique& c: cliques.values())
+		{
+			std::vector<uint32_t> numbers;
+			for (const VertexId v: c)
+				numbers.emplace_back((uint32_t)m_graph.number(v));
+			checkpoint.cliques.emplace_back(std::move(numbers));
+		}
+
+		try
+		{
+			writeSearchCheckpoint(checkpoint, m_settings.path);
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+		}
+
+		m_last = std::chrono::steady_clock::now();
+	}
+
+private:
+	const CheckpointSettings& m_settings;
+	const Graph<D>& m_graph;
+	uint64_t m_fingerprint;
+	size_t m_topLevelCount;
+	std::mutex m_mutex;
+	std::chrono::steady_clock::time_point m_last;
+};
+
+//threadCount > 1: les sommets du premier niveau et les branches de la recherche sont répartis entre threadCount threads.
+//duration reçoit la durée de la recherche, en millisecondes. Si limits arrête la recherche, le front renvoyé n'est pas
+//forcément complet: progress dit jusqu'où le premier niveau a été traité. Avec checkpoint.path, l'avancement est
+//enregistré régulièrement et à la fin de la recherche, et checkpoint.resume reprend là où il en était
+template <size_t D>
+Cliques<D> WLMC(const Graph<D>& G, long long& duration, SearchLimits& limits, SearchProgress& progress, const CheckpointSettings& checkpoint, const unsigned int threadCount = 1)
 {
 	const auto start = std::chrono::steady_clock::now();
-	InitReturnType i = initialize(G, {});
-	Cliques Cmax;   Cmax.set = { i.C0 };
+	InitReturnType<D> i = initialize(SubgraphView<D>(G), {}, &limits);
+	SharedCliques<D> Cmax (Cliques<D>(G.weight(i.C0), i.C0));
 	Vertices Vp = i.Gp.getVertices();
-	Vp.orderWith(i.O0);
 
-	for (size_t j = Vp.size() - 1; j < Vp.size(); --j)
+	//Arrêtée pendant initialize: Gp n'est pas forcément le graphe réduit dont les points de reprise ont l'empreinte,
+	//le point de reprise n'est ni lu ni écrit
+	if (limits.stopped())
 	{
-		const Vertex& vi = Vp[j];
-		Vertices P = Vertices::intersectionBetween(vi.neighbors, Vp.subSet(j + 1, Vp.size() - 1));
+		progress.count = Vp.size();
+		progress.finished = 0;
+		duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		return Cmax.get();
+	}
 
-		bool cliqueToImproveFound = false;
-		Clique cliqueToImprove;
+	//Les sommets retirés par initialize ne servent plus: on les enlève d'une copie du graphe une fois pour toutes, les
+	//listes de voisins parcourues ensuite sont plus courtes. Si initialize n'a rien retiré, G est utilisé tel quel
+	std::unique_ptr<Graph<D>> reduced;
+	if (Vp.size() < G.size())
+	{
+		Bitset removed (G.idCount());
+		for (const VertexId v: G.getVertices())
+			removed.set(v);
+		for (const VertexId v: Vp)
+			removed.reset(v);
 
-		//Si le poid estimé d'une clique est dominé par une clique de l'ensemble de pareto, on passe directement
-		//au sommet suivant. Dans le cas où cette condition n'arrive pas, on garde en mémoire la première clique
-		//que l'on trouve potentiellement améliorable
-		for (size_t i = 0; i < Cmax.set.size(); ++i)
-		{
-			//Le poids potentiel est dominé
-			if (Cmax.set[i].weight() > (P.weight() + vi.weight()))
-			{
-				cliqueToImproveFound = false;
-				break;
-			}
+		reduced.reset(new Graph<D>(G));
+		reduced->removeVertices(removed);
+	}
+	const Graph<D>& Gr = reduced ? *reduced : G;
 
-			//On enregistre la première clique améliorable
-			if (!((P.weight() + vi.weight()) <= Cmax.set[i].weight()))
+	i.O0.sort(Vp);
+
+	//P est l'ensemble des voisins de Vp[j] placés après lui dans Vp
+	std::vector<size_t> positionInVp (G.idCount());
+	for (size_t j = 0; j < Vp.size(); ++j)
+		positionInVp[Vp[j]] = j;
+
+	//Reprise: le front enregistré remplace celui des étapes déjà terminées, qui ne sont pas refaites
+	const uint64_t fingerprint = checkpoint.path.empty() ? 0 : reducedGraphFingerprint(Gr, Vp);
+	size_t firstStep = 0;
+
+	if (checkpoint.resume && fileExists(checkpoint.path))
+	{
+		const SearchCheckpoint saved = readSearchCheckpoint(checkpoint.path);
+
+		if ((saved.fingerprint != fingerprint) || (saved.topLevelCount != Vp.size()))
+			throw std::logic_error("ERROR: '" + checkpoint.path + "' is a checkpoint of another graph or of other weights");
+
+		std::unordered_map<uint32_t, VertexId> idOfNumber;
+		for (const VertexId v: G.getVertices())
+			idOfNumber[(uint32_t)G.number(v)] = v;
+
+		for (const std::vector<uint32_t>& numbers: saved.cliques)
+		{
+			PartialClique<D> c;
+			for (const uint32_t number: numbers)
 			{
-				if (!cliqueToImproveFound)
-				{
-					cliqueToImprove = Cmax.set[i];
-					cliqueToImproveFound = true;
-				}
+				auto found = idOfNumber.find(number);
+				if (found == idOfNumber.end())
+					throw std::logic_error("ERROR: '" + checkpoint.path + "' is a checkpoint of another graph or of other weights");
+				c = c.extendedWith(found->second, G.weight(found->second));
 			}
+			Cmax.tryInsert(c);
 		}
 
-		//On entre ici s'il existe une clique à améliorer
-		if (cliqueToImproveFound)
-		{
-			const Weight cliqueToImproveWeight = cliqueToImprove.weight();
-			const Weight viWeight = vi.weight();
+		firstStep = (size_t)saved.topLevelFinished;
+		std::cout << "Resuming from '" << checkpoint.path << "': " << firstStep << " of " << Vp.size() << " top level vertices finished" << std::endl;
+	}
 
-			InitReturnType ip = initialize(G[P], cliqueToImproveWeight - viWeight);
+	//Avec plusieurs threads, les sommets du premier niveau et les branches de la recherche sont des tâches du même groupe
+	std::unique_ptr<ThreadPool> pool (threadCount > 1 ? new ThreadPool(threadCount) : nullptr);
 
-			if (!((ip.C0.weight() + vi.weight()) <= cliqueToImprove.weight()))
-				cliqueToImprove = Vertices::unionBetween(ip.C0, vi);
+	TopLevelProgress topLevel (Vp.size(), firstStep);
+	std::unique_ptr<CheckpointWriter<D>> writer (checkpoint.path.empty() ? nullptr : new CheckpointWriter<D>(checkpoint, Gr, fingerprint, Vp.size()));
 
-			Cliques Cp = searchMaxWCliques(ip.Gp, cliqueToImprove, { {vi} }, ip.O0);
+	//Un sommet n'est terminé que si la recherche n'a pas été arrêtée pendant qu'il était traité
+	auto processVertex = [&Gr, &Vp, &positionInVp, &Cmax, &pool, &limits, &topLevel, &writer](const size_t j)
+	{
+		if (limits.shouldStop())
+			return;
 
-			for (const Clique& c: Cp.set)
-			{
-				if (!(c.weight() <= cliqueToImprove.weight()))
-					cliqueToImprove = c;
-				
-				//Maintenant que l'on a remplacé l'ancienne clique par une meilleure, on vérifie que cette clique n'est dominée par aucune autres cliques de l'ensemble. Si c'est le cas
-				//(ou si la clique est de même poids), on l'oublie
-				bool keepClique = true;
-				for (const Clique& c : Cmax.set)
-				{
-					if (cliqueToImprove.weight() <= c.weight())
-					{
-						keepClique = false;
-						break;
-					}
-				}
+		Vertices P;
+		for (const VertexId n: Gr.neighbors(Vp[j]))
+		{
+			if (positionInVp[n] > j)
+				P.emplace_back(n);
+		}
 
-				//Sinon, on supprime toutes les cliques dominées par cette nouvelle clique, puis on l'ajoute à l'ensemble des solutions
-				if (keepClique)
-				{
-					for (size_t i = 0; i < Cmax.set.size(); ++i)
-					{
-						if (Cmax.set[i].weight() <= cliqueToImprove.weight())
-						{
-							std::swap(Cmax.set[i],Cmax.set.back());
-							Cmax.set.pop_back();
-							--i;
-						}
-					}
-
-					Cmax.set.emplace_back(cliqueToImprove);
-				}
-			}
+		improveWithVertex(Gr, Vp[j], P, Cmax, pool.get(), limits);
+
+		if (!limits.stopped())
+		{
+			topLevel.markDone(Vp.size() - 1 - j);
+
+			if (writer != nullptr)
+				writer->tick(topLevel, Cmax);
 		}
+	};
+
+	if (pool == nullptr)
+	{
+		for (size_t j = Vp.size() - 1 - firstStep; (j < Vp.size()) && !limits.stopped(); --j)
+			processVertex(j);
 	}
+	else
+	{
+		for (size_t j = Vp.size() - 1 - firstStep; j < Vp.size(); --j)
+			pool->submit([&processVertex, j] { processVertex(j); });
+
+		pool->wait();
+	}
+
+	if (writer != nullptr)
+		writer->write(topLevel.finished(), Cmax);
+
 	const auto end = std::chrono::steady_clock::now();
 
-	duration = std::chrono::duration_cast<std::chrono::seconds>(end-start).count();
-	return Cmax;
+	progress.count = Vp.size();
+	progress.finished = topLevel.finished();
+	duration = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+	return Cmax.get();
 }
 
-static bool isClique (const Clique& c, const Edges& edges)
+template <size_t D>
+static bool isClique (const Clique& c, const Graph<D>& G)
 {
 	for (size_t i = 0; i < c.size(); ++i)
 	{
 		for (size_t j = i+1; j < c.size(); ++j)
 		{
-			bool found = false;
-
-			for (const Edge& e: edges)
-			{
-				if (((e.first == c[i]) && (e.second == c[j])) || 
-					((e.first == c[j]) && (e.second == c[i])))
-				{
-					found = true;
-					break;
-				}
-			}
-
-			if (!found) return false;
+			if (!G.adjacent(c[i], c[j])) return false;
 		}
 	}
 
 	return true;
 }
 
+//Le premier signal arrête la recherche proprement (voir SearchLimits), le front trouvé est alors affiché. Le second
+//termine le programme tout de suite
 static void signalHandler(const int sigNum)
 {
-	std::cerr << "Exiting with signal: " << sigNum << std::endl;
-	exit(EXIT_FAILURE);
+	int none = 0;
+	if (!receivedSignal.compare_exchange_strong(none, sigNum))
+		std::_Exit(EXIT_FAILURE);
 }
 
 static void setup (void)
@@ -350,27 +1003,381 @@ static void setup (void)
 #endif
 }
 
+//Code de sortie quand la recherche a été arrêtée avant la fin: le front affiché n'est pas forcément complet
+constexpr int EXIT_INCOMPLETE = 2;
+
+static const char* stopReasonName(const SearchLimits::Reason reason)
+{
+	switch (reason)
+	{
+		case SearchLimits::Reason::Signal: return "signal";
+		case SearchLimits::Reason::TimeLimit: return "time limit";
+		case SearchLimits::Reason::NodeLimit: return "node limit";
+		default: return "none";
+	}
+}
+
+//Résultat de la recherche sur un graphe
+struct SolveResult
+{
+	VerticesSet front;//Triées par poids, les sommets de chaque clique sont triés par numéro
+	SearchProgress progress;
+	long long duration = 0;//Durée de la recherche, en millisecondes
+};
+
+//Lance la recherche avec les poids de G réduits aux colonnes columns des poids lus (D = columns.size()). L'adjacence
+//de raw est déplacée dans le graphe, sans copie
+template <size_t D>
+static SolveResult search(RawGraph& raw, const std::vector<unsigned int>& columns, const float density, const unsigned int threadCount,
+	SearchLimits& limits, const CheckpointSettings& checkpoint, const bool verbose)
+{
+	SolveResult ret;
+	Graph<D> G (raw, columns);
+
+	if ((density >= DENSE_BACKEND_MIN_DENSITY) && (G.denseAdjacencyBytes() <= DENSE_BACKEND_MAX_BYTES))
+	{
+		if (verbose)
+			std::cout << "Using dense adjacency matrix" << std::endl;
+		G.buildDenseAdjacency();
+	}
+
+	ret.front.set = WLMC(G,ret.duration,limits,ret.progress,checkpoint,threadCount).values();
+
+	for (Clique& c: ret.front.set)
+		std::sort(c.begin(),c.end(),[&G](const VertexId a, const VertexId b) { return G.number(a) < G.number(b); });
+
+	//L'ordre dans lequel les cliques sont trouvées dépend du nombre de threads, on les affiche triées par poids
+	std::sort(ret.front.set.begin(),ret.front.set.end(),[&raw](const Clique& a, const Clique& b)
+		{
+			const std::vector<float> wa = fileWeight(raw, a);
+			const std::vector<float> wb = fileWeight(raw, b);
+			return std::lexicographical_compare(wb.begin(), wb.end(), wa.begin(), wa.end());
+		});
+
+	return ret;
+}
+
+//Colonnes des poids lus utilisées par la recherche. reduceWeights: les colonnes toujours nulles et les colonnes en
+//double ne sont pas utilisées
+static std::vector<unsigned int> searchColumns(const RawGraph& raw, const bool reduceWeights)
+{
+	if (reduceWeights)
+		return significantWeightColumns(raw);
+
+	std::vector<unsigned int> ret;
+	for (unsigned int c = 0; c < raw.weightCount; ++c)
+		ret.emplace_back(c);
+	return ret;
+}
+
+static bool isSupportedWeightCount(const size_t count) { return (count >= 1) && (count <= MAX_WEIGHTS_SIZE); }
+
+//Une version du solveur par nombre de poids: isSupportedWeightCount(columns.size()) doit être vrai
+static SolveResult solve(RawGraph& raw, const std::vector<unsigned int>& columns, const float density, const unsigned int threadCount,
+	SearchLimits& limits, const CheckpointSettings& checkpoint, const bool verbose)
+{
+	switch (columns.size())
+	{
+		case 1: return search<1>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		case 2: return search<2>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		case 3: return search<3>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		case 4: return search<4>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		case 5: return search<5>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		case 6: return search<6>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		case 7: return search<7>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		case 8: return search<8>(raw, columns, density, threadCount, limits, checkpoint, verbose);
+		default: break;
+	}
+
+	throw std::logic_error("WLMC is compiled for vertices with 1 to " + std::to_string(MAX_WEIGHTS_SIZE) + " weights");
+}
+
+static std::string unsupportedWeightCountMessage(const std::string& path, const size_t count)
+{
+	return "WLMC is compiled for vertices with 1 to " + std::to_string(MAX_WEIGHTS_SIZE) + " weights, but '" + path + "' contains vertices with " + std::to_string(count) + " weights";
+}
+
+//Chaîne JSON entre guillemets
+static std::string jsonString(const std::string& text)
+{
+	std::string ret = "\"";
+
+	for (const char c: text)
+	{
+		if ((c == '"') || (c == '\\'))
+			ret += std::string("\\") + c;
+		else if ((unsigned char)c < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)c);
+			ret += escaped;
+		}
+		else
+			ret += c;
+	}
+
+	return ret + "\"";
+}
+
+//Paramètres communs à tous les graphes d'un lot
+struct BatchSettings
+{
+	bool reduceWeights = false;
+	double timeLimit = 0.0;//Par graphe, en secondes, lecture comprise
+	unsigned long long nodeLimit = 0;//Par graphe
+};
+
+//Résout un graphe d'un lot et renvoie son enregistrement, une ligne JSON: le fichier, l'état ("ok", "incomplete" si la
+//recherche a été arrêtée, "skipped" si un signal a été reçu avant qu'elle commence, "error"), la taille du graphe, les
+//durées en millisecondes et le front. status reçoit le code de sortie qu'aurait wlmc sur ce seul graphe
+static std::string solveBatchGraph(const std::string& path, const BatchSettings& settings, int& status)
+{
+	std::ostringstream record;
+	record << "{ \"file\": " << jsonString(path);
+
+	if (receivedSignal.load() != 0)
+	{
+		status = EXIT_INCOMPLETE;
+		record << ", \"status\": \"skipped\" }";
+		return record.str();
+	}
+
+	try
+	{
+		SearchLimits limits ((long long)(settings.timeLimit * 1000.0), settings.nodeLimit);
+		//Les graphes sont lus et résolus en parallèle, chacun par un seul thread. Chaque thread garde ses tableaux de
+		//lecture d'un graphe à l'autre
+		static thread_local GraphReadBuffers buffers;
+		GraphFileReader reader (path, 1, &buffers);
+		RawGraph raw (reader.readFile(false));
+		const size_t vertexCount = raw.numbers.size();
+		const size_t edgeCount = raw.edgeCount();
+
+		const std::vector<unsigned int> columns = searchColumns(raw, settings.reduceWeights);
+		if (!isSupportedWeightCount(columns.size()))
+			throw std::logic_error(unsupportedWeightCountMessage(path, columns.size()));
+
+		const SolveResult result = solve(raw, columns, reader.getDensity(), 1, limits, CheckpointSettings(), false);
+		status = limits.stopped() ? EXIT_INCOMPLETE : EXIT_SUCCESS;
+
+		record << ", \"status\": " << (limits.stopped() ? "\"incomplete\"" : "\"ok\"") << ", \"vertices\": " << vertexCount
+			<< ", \"edges\": " << edgeCount << ", \"read_ms\": " << reader.getDuration() << ", \"solve_ms\": " << result.duration
+			<< ", \"cliques\": " << result.front.set.size() << ", \"front\": [";
+
+		for (size_t i = 0; i < result.front.set.size(); ++i)
+		{
+			const Clique& c = result.front.set[i];
+			record << ((i == 0) ? " " : ", ") << "{ \"vertices\": [";
+			for (size_t k = 0; k < c.size(); ++k)
+				record << ((k == 0) ? "" : ", ") << raw.numbers[c[k]];
+
+			record << "], \"weight\": [";
+			const std::vector<float> w = fileWeight(raw, c);
+			for (size_t k = 0; k < w.size(); ++k)
+				record << ((k == 0) ? "" : ", ") << w[k];
+			record << "] }";
+		}
+
+		record << " ] }";
+	}
+	catch (const std::exception& e)
+	{
+		status = EXIT_FAILURE;
+		record.str("");
+		record << "{ \"file\": " << jsonString(path) << ", \"status\": \"error\", \"error\": " << jsonString(e.what()) << " }";
+	}
+
+	return record.str();
+}
+
+//Résout les graphes de paths sur threadCount threads, un graphe par tâche, et écrit leurs enregistrements sur la
+//sortie standard dans l'ordre où ils sont résolus. Renvoie EXIT_FAILURE si un graphe n'a pas pu être résolu, sinon
+//EXIT_INCOMPLETE si une recherche a été arrêtée
+static int solveBatch(const std::vector<std::string>& paths, const BatchSettings& settings, const unsigned int threadCount)
+{
+	std::mutex outputMutex;
+	int ret = EXIT_SUCCESS;
+	ThreadPool pool (threadCount);
+
+	for (const std::string& path: paths)
+	{
+		pool.submit([&outputMutex, &ret, &settings, path]
+			{
+				int status = EXIT_SUCCESS;
+				const std::string record = solveBatchGraph(path, settings, status);
+
+				std::lock_guard<std::mutex> lock (outputMutex);
+				std::cout << record << std::endl;
+
+				if (status == EXIT_FAILURE)
+					ret = EXIT_FAILURE;
+				else if ((status == EXIT_INCOMPLETE) && (ret == EXIT_SUCCESS))
+					ret = EXIT_INCOMPLETE;
+			});
+	}
+
+	pool.wait();
+	return ret;
+}
+
+//Format: wlmc [--threads <n>] [--reduce-weights] [--stats] [--time-limit <seconds>] [--node-limit <n>]
+//             [--checkpoint <path> [--checkpoint-interval <seconds>] [--resume]] [--convert <snapshot path>] <file path>
+//        wlmc [--threads <n>] [--reduce-weights] [--stats] [--time-limit <seconds>] [--node-limit <n>]
+//             [--batch <directory or manifest>]... [<file path>]...
+//--convert: enregistre le graphe lu dans un fichier binaire (voir graphSnapshot.hpp) au lieu de lancer la recherche
+//--stats: affiche les compteurs de la recherche (voir searchStats.hpp), seulement si wlmc est compilé avec -DWLMC_STATS
+//--time-limit, --node-limit: la recherche s'arrête après cette durée depuis le lancement (lecture comprise) ou ce nombre
+//de noeuds, comme avec SIGINT ou SIGTERM. Le front trouvé est affiché comme incomplet et wlmc renvoie EXIT_INCOMPLETE
+//--checkpoint: enregistre l'avancement de la recherche dans ce fichier toutes les --checkpoint-interval secondes (60 par
+//défaut) et quand elle s'arrête. --resume reprend la recherche enregistrée au lieu de la recommencer
+//--batch ou plusieurs fichiers: les graphes sont résolus par --threads threads, un graphe par thread, et chacun donne
+//une ligne JSON (voir solveBatchGraph). Les limites s'appliquent à chaque graphe. Un dossier donne tous ses fichiers,
+//un manifeste un fichier par ligne (voir batchList.hpp). Un dossier ou un manifeste illisible donne une ligne "error"
+//comme un graphe illisible, les autres graphes sont quand même résolus et wlmc renvoie EXIT_FAILURE. Chaque thread
+//réutilise d'un graphe à l'autre ses tableaux de lecture (GraphReadBuffers) et de recherche (BranchScratch), qui
+//gardent la taille du plus gros graphe qu'il a traité
 int main(int argc, const char** argv)
 {
-	if (argc != 2)
+	std::vector<std::string> paths;
+	std::vector<std::string> batches;
+	unsigned int threadCount = 1;
+	const char* snapshotPath = nullptr;
+	bool reduceWeights = false;
+	bool stats = false;
+	double timeLimit = 0.0;
+	unsigned long long nodeLimit = 0;
+	CheckpointSettings checkpoint;
+	bool argumentsOk = true;
+
+	for (int a = 1; a < argc; ++a)
 	{
-		std::cerr << "arguments are <file path>\n";
+		const std::string arg (argv[a]);
+
+		if ((arg == "--threads") && (a + 1 < argc))
+		{
+			threadCount = (unsigned int)std::stoul(argv[++a]);
+
+			//--threads 0: autant de threads que de coeurs
+			if (threadCount == 0)
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+		else if (arg == "--reduce-weights")
+			reduceWeights = true;
+		else if (arg == "--stats")
+			stats = true;
+		else if ((arg == "--time-limit") && (a + 1 < argc))
+			timeLimit = std::stod(argv[++a]);
+		else if ((arg == "--node-limit") && (a + 1 < argc))
+			nodeLimit = std::stoull(argv[++a]);
+		else if ((arg == "--checkpoint") && (a + 1 < argc))
+			checkpoint.path = argv[++a];
+		else if ((arg == "--checkpoint-interval") && (a + 1 < argc))
+			checkpoint.interval = (long long)(std::stod(argv[++a]) * 1000.0);
+		else if (arg == "--resume")
+			checkpoint.resume = true;
+		else if ((arg == "--convert") && (a + 1 < argc))
+			snapshotPath = argv[++a];
+		else if ((arg == "--batch") && (a + 1 < argc))
+			batches.emplace_back(argv[++a]);
+		else if ((arg.size() > 2) && (arg.compare(0, 2, "--") == 0))
+			argumentsOk = false;
+		else
+			paths.emplace_back(arg);
+	}
+
+	const bool batch = !batches.empty() || (paths.size() > 1);
+
+	if (!argumentsOk || (paths.empty() && batches.empty()) || (checkpoint.resume && checkpoint.path.empty()) ||
+		(batch && (!checkpoint.path.empty() || (snapshotPath != nullptr))))
+	{
+		std::cerr << "arguments are [--threads <n>] [--reduce-weights] [--stats] [--time-limit <seconds>] [--node-limit <n>]\n"
+			"              [--checkpoint <path> [--checkpoint-interval <seconds>] [--resume]] [--convert <snapshot path>] <file path>\n"
+			"           or [--threads <n>] [--reduce-weights] [--stats] [--time-limit <seconds>] [--node-limit <n>]\n"
+			"              [--batch <directory or manifest>]... [<file path>]...\n";
 		return EXIT_FAILURE;
 	}
 
+#if !defined(WLMC_STATS)
+	if (stats)
+	{
+		std::cerr << "WLMC is compiled without search statistics: build it with -DWLMC_STATS (make wlmc-stats) to use --stats\n";
+		stats = false;
+	}
+#endif
+
 	setup();
 
-	long long WLMCDuration = 0;
-	VertexStructContainer container;
-	GraphFileReader reader (argv[1]);
-	std::pair<Vertices, Edges> pair = reader.readFile(container);
+	if (batch)
+	{
+		bool listsOk = true;
 
-	Cliques Cmax = WLMC(Graph(pair.first,pair.second),WLMCDuration);
+		for (const std::string& b: batches)
+		{
+			try
+			{
+				const std::vector<std::string> files = listBatchFiles(b);
+				paths.insert(paths.end(), files.begin(), files.end());
+			}
+			catch (const std::exception& e)
+			{
+				listsOk = false;
+				std::cout << "{ \"file\": " << jsonString(b) << ", \"status\": \"error\", \"error\": " << jsonString(e.what()) << " }" << std::endl;
+			}
+		}
+
+		BatchSettings settings;
+		settings.reduceWeights = reduceWeights;
+		settings.timeLimit = timeLimit;
+		settings.nodeLimit = nodeLimit;
+
+		const int solved = solveBatch(paths, settings, threadCount);
+		const int ret = listsOk ? solved : EXIT_FAILURE;
+
+		if (stats)
+			printSearchStats(std::cerr, SearchStatsRegistry::instance().total());
+
+		return ret;
+	}
+
+	const std::string path = paths[0];
+	SearchLimits limits ((long long)(timeLimit * 1000.0), nodeLimit);
+
+	GraphFileReader reader (path);
+	RawGraph raw (reader.readFile());
+
+	if (snapshotPath != nullptr)
+	{
+		writeGraphSnapshot(raw, snapshotPath);
+		std::cout << "Graph written to '" << snapshotPath << "'" << std::endl;
+		return EXIT_SUCCESS;
+	}
 
-	for (Clique& c: Cmax.set)
-		std::sort(c.begin(),c.end(),[](const Vertex& a, const Vertex& b) { return a.num() < b.num(); });
-	std::cout << Cmax << std::endl;
+	const std::vector<unsigned int> columns = searchColumns(raw, reduceWeights);
 
-	std::cout << "found: " << Cmax.set.size() << " cliques   took: " << WLMCDuration << "s" << std::endl;
-	return EXIT_SUCCESS;
-}
\ No newline at end of file
+	if (columns.size() != raw.weightCount)
+		std::cout << "Searching with " << columns.size() << " of " << raw.weightCount << " weights" << std::endl;
+
+	if (!isSupportedWeightCount(columns.size()))
+	{
+		std::cerr << unsupportedWeightCountMessage(path, columns.size()) << "\n";
+		return EXIT_FAILURE;
+	}
+
+	const SolveResult result = solve(raw, columns, reader.getDensity(), threadCount, limits, checkpoint, true);
+	printVerticesSet(std::cout, raw, result.front) << std::endl;
+
+	//Les cliques affichées sont bien des cliques, mais d'autres cliques non trouvées peuvent les dominer
+	if (limits.stopped())
+	{
+		std::cout << "INCOMPLETE front: search stopped by " << stopReasonName(limits.reason()) << " after " << limits.nodes()
+			<< " nodes   top level vertices finished: " << result.progress.finished << " of " << result.progress.count << std::endl;
+	}
+
+	std::cout << "found: " << result.front.set.size() << " cliques   took: " << result.duration << "ms" << std::endl;
+
+	//Les compteurs de la recherche sont affichés sur la sortie d'erreur
+	if (stats)
+		printSearchStats(std::cerr, SearchStatsRegistry::instance().total());
+
+	return limits.stopped() ? EXIT_INCOMPLETE : EXIT_SUCCESS;
+}